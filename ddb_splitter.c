@@ -18,7 +18,12 @@
  */
 
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 #include "ddb_splitter.h"
+#include "ddb_splitter_layout.h"
+#include "ddb_splitter_sync_group.h"
+#include "ddb_splitter_trace.h"
 
 /**
  * SECTION: ddb-splitter
@@ -37,8 +42,32 @@ enum
     PROP_ORIENTATION,
     PROP_SIZE_MODE,
     PROP_PROPORTION,
+    PROP_LOCKED_SIZE,
+    PROP_SYNC_GROUP,
+    PROP_DEFER_INTERVAL,
+    PROP_ACTIVE_CHILD,
+    PROP_UNREALIZE_TIMEOUT,
+    PROP_HEATMAP,
+    PROP_VIRTUALIZE,
+    PROP_COPY_ON_MOVE,
 };
 
+/* Child property identifiers */
+enum
+{
+    CHILD_PROP_0,
+    CHILD_PROP_DEFER_ALLOCATION,
+    CHILD_PROP_MIN_SIZE,
+    CHILD_PROP_MAX_SIZE,
+    CHILD_PROP_MIN_FRACTION,
+    CHILD_PROP_MAX_FRACTION,
+    CHILD_PROP_SHRINK,
+};
+
+/* Time without size changes after which deferred children get their
+ * final allocation, in milliseconds */
+#define DDB_SPLITTER_SETTLE_DELAY 150
+
 #if !GTK_CHECK_VERSION(3,0,0)
 static void
 ddb_splitter_size_request (GtkWidget        *widget,
@@ -79,6 +108,12 @@ ddb_splitter_grab_broken (GtkWidget *widget,
 static void
 ddb_splitter_grab_notify (GtkWidget *widget,
                        gboolean   was_grabbed);
+static void
+ddb_splitter_parent_set (GtkWidget *widget,
+                         GtkWidget *previous_parent);
+static void
+ddb_splitter_hierarchy_changed (GtkWidget *widget,
+                                GtkWidget *previous_toplevel);
 static gboolean
 ddb_splitter_motion (GtkWidget *widget,
                      GdkEventMotion *event);
@@ -91,6 +126,14 @@ static gboolean
 ddb_splitter_expose (GtkWidget      *widget,
                   GdkEventExpose *event);
 #endif
+#if GTK_CHECK_VERSION(3,0,0)
+static void
+ddb_splitter_style_updated (GtkWidget *widget);
+#else
+static void
+ddb_splitter_style_set (GtkWidget *widget,
+                        GtkStyle  *previous_style);
+#endif
 static void
 ddb_splitter_realize (GtkWidget *widget);
 
@@ -103,6 +146,15 @@ ddb_splitter_map (GtkWidget *widget);
 static void
 ddb_splitter_unmap (GtkWidget *widget);
 
+static void
+ddb_splitter_dispose (GObject *object);
+
+static void
+ddb_splitter_finalize (GObject *object);
+
+static void
+ddb_splitter_stats_dump (void);
+
 static void
 ddb_splitter_get_property (GObject *object,
                            guint prop_id,
@@ -122,6 +174,28 @@ static void
 ddb_splitter_size_allocate (GtkWidget *widget,
                             GtkAllocation *allocation);
 static void
+ddb_splitter_relayout (DdbSplitter *splitter);
+static void
+ddb_splitter_layout_input (DdbSplitter *splitter, const GtkAllocation *allocation, DdbSplitterLayoutInput *input);
+static gint
+ddb_splitter_child_pos (DdbSplitter *splitter, GtkWidget *child);
+static void
+ddb_splitter_heat_stop (DdbSplitter *splitter);
+static void
+ddb_splitter_clip_update (DdbSplitter *splitter, guint pos);
+static void
+ddb_splitter_clip_remove (DdbSplitter *splitter, guint pos);
+static gboolean
+ddb_splitter_handle_visible (GtkWidget *widget);
+static void
+ddb_splitter_animation_remove (DdbSplitter *splitter);
+static void
+ddb_splitter_virtual_scrolled (GtkAdjustment *adjustment, gpointer user_data);
+static void
+ddb_splitter_virtual_track (DdbSplitter *splitter, GtkAdjustment *hadjustment, GtkAdjustment *vadjustment);
+static gboolean
+ddb_splitter_animation_step (DdbSplitter *splitter, gint64 now);
+static void
 ddb_splitter_add (GtkContainer *container,
                   GtkWidget *widget);
 static void
@@ -132,6 +206,78 @@ ddb_splitter_forall (GtkContainer *container,
                      gboolean include_internals,
                      GtkCallback callback,
                      gpointer callback_data);
+static void
+ddb_splitter_get_child_property (GtkContainer *container,
+                                 GtkWidget *child,
+                                 guint prop_id,
+                                 GValue *value,
+                                 GParamSpec *pspec);
+static void
+ddb_splitter_set_child_property (GtkContainer *container,
+                                 GtkWidget *child,
+                                 guint prop_id,
+                                 const GValue *value,
+                                 GParamSpec *pspec);
+
+/* Where the children and the handle go, see ddb_splitter_compute_layout() */
+typedef DdbSplitterLayoutResult DdbSplitterLayout;
+
+/* Changes posted from other threads, see ddb_splitter_post_proportion() */
+enum
+{
+    DDB_SPLITTER_POST_PROPORTION  = 1 << 0,
+    DDB_SPLITTER_POST_SIZE_MODE   = 1 << 1,
+    DDB_SPLITTER_POST_LOCKED_SIZE = 1 << 2,
+};
+
+/* The heat-map overlay covers the last second in buckets of 100 ms */
+#define DDB_SPLITTER_HEAT_BUCKETS 10
+#define DDB_SPLITTER_HEAT_BUCKET 100000
+/* How long handles flash after moving, in µs */
+#define DDB_SPLITTER_HEAT_FLASH 300000
+
+/* State kept for the child in each slot */
+typedef struct
+{
+    guint defer_allocation : 1;
+    guint allocated : 1;
+    guint deferred : 1;
+    guint visible : 1;
+    /* limits of the size along the split */
+    guint shrink : 1;
+    gint min_size;
+    gint max_size;
+    gfloat min_fraction;
+    gfloat max_fraction;
+    /* what the child was last given, or its slot when it has a clip
+     * window */
+    GtkAllocation allocation;
+    /* window the child sits in while it defers allocations, so it can
+     * keep its size while the slot changes, and the size it has in there */
+    GdkWindow *clip;
+    gint clip_width;
+    gint clip_height;
+    gulong clip_map_id;
+    gulong clip_unmap_id;
+    /* when the child last got a new size */
+    gint64 sized_time;
+    /* size request seen by the last allocation, for thrash detection */
+    GtkRequisition requisition;
+    /* stands in for the size request of a child that is slow to measure */
+    guint size_pending : 1;
+    guint size_hinted : 1;
+    GtkRequisition size_hint;
+    /* own request of the child when the hint became ready, -1 until seen */
+    gint size_hint_basis[2];
+    /* heat-map overlay */
+    gulong heat_draw_id;
+    gint64 heat_allocate_time;
+    guint heat_allocations[DDB_SPLITTER_HEAT_BUCKETS];
+    guint heat_paints[DDB_SPLITTER_HEAT_BUCKETS];
+    /* out of view in virtualize mode, and what it gets once back in view */
+    guint virtualized : 1;
+    GtkAllocation virtual_allocation;
+} DdbSplitterChildInfo;
 
 struct _DdbSplitterPrivate
 {
@@ -139,11 +285,30 @@ struct _DdbSplitterPrivate
     GtkWidget *child2;
     guint child1_size;
     guint child2_size;
+    DdbSplitterChildInfo info[2];
+
+    /* deferred child allocations */
+    guint defer_interval;
+    guint defer_id;
+    guint flush_deferred : 1;
 
     GdkWindow *handle;
     GdkRectangle handle_pos;
     gint handle_size;
+
+    /* the rendered handle, reused as long as its look doesn't change */
+#if GTK_CHECK_VERSION(3,0,0)
+    cairo_surface_t *handle_cache;
+#else
+    GdkPixmap *handle_cache;
+#endif
+    gint handle_cache_width;
+    gint handle_cache_height;
+    gint handle_cache_state;
+    GtkOrientation handle_cache_orientation;
+    DdbSplitterSizeMode handle_cache_size_mode;
     gint drag_pos;
+    gint add_pos;
     guint in_drag : 1;
     guint position_set : 1;
     guint32 grab_time;
@@ -152,8 +317,97 @@ struct _DdbSplitterPrivate
     GtkOrientation orientation;
     DdbSplitterSizeMode size_mode;
     gfloat proportion;
+    DdbSplitterSyncGroup *sync_group;
+
+    /* heat-map overlay */
+    guint heatmap : 1;
+    guint heat_self_redraw : 1;
+    guint heat_id;
+    /* ends heat_self_redraw once the overlay has been repainted */
+#if GTK_CHECK_VERSION(3,8,0)
+    GdkFrameClock *heat_clock;
+    gulong heat_paint_id;
+#else
+    guint heat_paint_id;
+#endif
+    gint64 heat_slot;
+    gint64 heat_flash_until;
+
+    /* virtualize mode: the part of the viewport in view, in the
+     * coordinates of our allocation. Only the topmost virtualized
+     * splitter follows the scrolling, and hands the view down to the
+     * nested splitters in view */
+    guint virtualize : 1;
+    guint virtual_ancestor : 1;
+    guint virtual_active : 1;
+    GdkRectangle virtual_view;
+    GtkAdjustment *virtual_adjustments[2];
+    gulong virtual_handlers[2];
+
+    /* children that only move are copied instead of repainted */
+    guint copy_on_move : 1;
+    /* set while a child is moved by copying, nested splitters inside it
+     * then leave their children alone */
+    guint translating : 1;
+
+    /* stack mode */
+    guint active_child : 1;
+    gint unrealize_timeout;
+    guint unrealize_id;
+
+    /* running animation */
+    guint anim_id;
+    gint64 anim_start;
+    guint anim_duration;
+    DdbSplitterEasing anim_easing;
+    guint anim_locked : 1;
+    gfloat anim_from;
+    gfloat anim_to;
+
+    /* mailbox for changes posted from other threads, only the latest
+     * value of each property is kept */
+    volatile gint post_pending;
+    volatile gint post_proportion;
+    volatile gint post_size_mode;
+    volatile gint post_locked_size;
+
+    /* layout thrash detection */
+    gint64 thrash_frame;
+    guint thrash_allocations;
+    guint thrash_reported : 1;
+    gint thrash_child;
+    GtkRequisition thrash_req_from;
+    GtkRequisition thrash_req_to;
+    gfloat thrash_history[2][4];
+    guint thrash_history_len[2];
+
+    DdbSplitterStats stats;
 };
 
+#define DDB_SPLITTER_TRACE_BEGIN(splitter, name) G_STMT_START { \
+    if (DDB_SPLITTER_TRACE_ACTIVE ()) ddb_splitter_trace ((splitter), (name), 'B'); \
+} G_STMT_END
+#define DDB_SPLITTER_TRACE_END(splitter, name) G_STMT_START { \
+    if (DDB_SPLITTER_TRACE_ACTIVE ()) ddb_splitter_trace ((splitter), (name), 'E'); \
+} G_STMT_END
+
+/* Splitters alive while DDB_SPLITTER_STATS is set, and the summed up
+ * statistics of the ones already gone */
+static GList *stats_splitters = NULL;
+static DdbSplitterStats stats_retired;
+static gboolean stats_dump = FALSE;
+
+/* Whether new splitters show the heat-map overlay */
+static gboolean heatmap_default = FALSE;
+
+/* Allocations per frame above which a splitter is reported as thrashing,
+ * 0 when detection is off */
+static guint thrash_limit = 0;
+static gboolean thrash_break = FALSE;
+
+/* Length of a frame in µs, used where there's no frame clock */
+#define DDB_SPLITTER_FRAME_INTERVAL 16000
+
 G_DEFINE_TYPE (DdbSplitter, ddb_splitter, GTK_TYPE_CONTAINER)
 
 static void
@@ -166,7 +420,24 @@ ddb_splitter_class_init (DdbSplitterClass *klass)
     /* add our private data to the class */
     g_type_class_add_private (klass, sizeof (DdbSplitterPrivate));
 
+    _ddb_splitter_trace_init ();
+
+    heatmap_default = g_getenv ("DDB_SPLITTER_HEATMAP") != NULL;
+
+    const gchar *thrash = g_getenv ("DDB_SPLITTER_THRASH");
+    if (thrash) {
+        guint limit = strtoul (thrash, NULL, 10);
+        ddb_splitter_set_thrash_detection (limit > 0 ? limit : 3, g_getenv ("DDB_SPLITTER_THRASH_BREAK") != NULL);
+    }
+
+    if (g_getenv ("DDB_SPLITTER_STATS")) {
+        stats_dump = TRUE;
+        atexit (ddb_splitter_stats_dump);
+    }
+
     gobject_class = G_OBJECT_CLASS (klass);
+    gobject_class->dispose = ddb_splitter_dispose;
+    gobject_class->finalize = ddb_splitter_finalize;
     gobject_class->get_property = ddb_splitter_get_property;
     gobject_class->set_property = ddb_splitter_set_property;
 
@@ -183,8 +454,10 @@ ddb_splitter_class_init (DdbSplitterClass *klass)
     gtkwidget_class->realize = ddb_splitter_realize;
 #if GTK_CHECK_VERSION(3,0,0)
     gtkwidget_class->draw = ddb_splitter_draw;
+    gtkwidget_class->style_updated = ddb_splitter_style_updated;
 #else
     gtkwidget_class->expose_event = ddb_splitter_expose;
+    gtkwidget_class->style_set = ddb_splitter_style_set;
 #endif
     gtkwidget_class->unrealize = ddb_splitter_unrealize;
     gtkwidget_class->map = ddb_splitter_map;
@@ -194,11 +467,15 @@ ddb_splitter_class_init (DdbSplitterClass *klass)
     gtkwidget_class->motion_notify_event = ddb_splitter_motion;
     gtkwidget_class->grab_broken_event = ddb_splitter_grab_broken;
     gtkwidget_class->grab_notify = ddb_splitter_grab_notify;
+    gtkwidget_class->parent_set = ddb_splitter_parent_set;
+    gtkwidget_class->hierarchy_changed = ddb_splitter_hierarchy_changed;
 
     gtkcontainer_class = GTK_CONTAINER_CLASS (klass);
     gtkcontainer_class->add = ddb_splitter_add;
     gtkcontainer_class->remove = ddb_splitter_remove;
     gtkcontainer_class->forall = ddb_splitter_forall;
+    gtkcontainer_class->get_child_property = ddb_splitter_get_child_property;
+    gtkcontainer_class->set_child_property = ddb_splitter_set_child_property;
 
     /**
      * DdbSplitter::size_mode:
@@ -236,6 +513,211 @@ ddb_splitter_class_init (DdbSplitterClass *klass)
                 "The percentage of space allocated to the first child",
                 -G_MAXFLOAT, 1.0, -1.0,
                 G_PARAM_READWRITE));
+    /**
+     * DdbSplitter::locked-size:
+     *
+     * The size of the locked child, -1 if no child is locked.
+     **/
+    g_object_class_install_property (gobject_class,
+            PROP_LOCKED_SIZE,
+            g_param_spec_int ("locked-size",
+                "Locked size",
+                "The size of the locked child",
+                -1, G_MAXINT, -1,
+                G_PARAM_READWRITE));
+    /**
+     * DdbSplitter::sync-group:
+     *
+     * The #DdbSplitterSyncGroup the splitter shares its proportion
+     * and locked size with.
+     **/
+    g_object_class_install_property (gobject_class,
+            PROP_SYNC_GROUP,
+            g_param_spec_object ("sync-group",
+                "Sync group",
+                "The group the splitter shares its proportion and locked size with",
+                DDB_TYPE_SPLITTER_SYNC_GROUP,
+                G_PARAM_READWRITE));
+    /**
+     * DdbSplitter::defer-interval:
+     *
+     * How often children with #DdbSplitter:defer-allocation set get a
+     * new size while the splitter is being resized, in milliseconds.
+     * 0 means only once the size stops changing.
+     **/
+    g_object_class_install_property (gobject_class,
+            PROP_DEFER_INTERVAL,
+            g_param_spec_uint ("defer-interval",
+                "Defer interval",
+                "How often deferred children are resized during a resize, 0 to wait until it settles",
+                0, G_MAXINT, 0,
+                G_PARAM_READWRITE));
+    /**
+     * DdbSplitter::active-child:
+     *
+     * The slot of the child that is shown in the
+     * %DDB_SPLITTER_SIZE_MODE_STACK size mode, 0 or 1.
+     **/
+    g_object_class_install_property (gobject_class,
+            PROP_ACTIVE_CHILD,
+            g_param_spec_uint ("active-child",
+                "Active child",
+                "The slot of the child shown in stack mode",
+                0, 1, 0,
+                G_PARAM_READWRITE));
+    /**
+     * DdbSplitter::unrealize-timeout:
+     *
+     * How long the inactive child stays realized in the
+     * %DDB_SPLITTER_SIZE_MODE_STACK size mode, in milliseconds.
+     * -1 keeps it realized.
+     **/
+    g_object_class_install_property (gobject_class,
+            PROP_UNREALIZE_TIMEOUT,
+            g_param_spec_int ("unrealize-timeout",
+                "Unrealize timeout",
+                "How long the inactive child stays realized in stack mode, -1 for ever",
+                -1, G_MAXINT, -1,
+                G_PARAM_READWRITE));
+    /**
+     * DdbSplitter::heatmap:
+     *
+     * Whether the splitter shows a debug overlay of how often its children
+     * are allocated and repainted. Defaults to %TRUE if the environment
+     * variable DDB_SPLITTER_HEATMAP is set.
+     **/
+    g_object_class_install_property (gobject_class,
+            PROP_HEATMAP,
+            g_param_spec_boolean ("heatmap",
+                "Heat-map",
+                "Whether to show how often the children are allocated and repainted",
+                FALSE,
+                G_PARAM_READWRITE));
+    /**
+     * DdbSplitter::virtualize:
+     *
+     * Whether children scrolled out of view of the enclosing #GtkViewport
+     * are unmapped and no longer allocated. Applies to the nested
+     * splitters below as well.
+     **/
+    g_object_class_install_property (gobject_class,
+            PROP_VIRTUALIZE,
+            g_param_spec_boolean ("virtualize",
+                "Virtualize",
+                "Whether children out of view of the viewport are skipped",
+                FALSE,
+                G_PARAM_READWRITE));
+    /**
+     * DdbSplitter::copy-on-move:
+     *
+     * Whether children without a window of their own that keep their size
+     * but change their position are moved by copying what they show,
+     * instead of being repainted. Has no effect with GTK 3.16 and later.
+     **/
+    g_object_class_install_property (gobject_class,
+            PROP_COPY_ON_MOVE,
+            g_param_spec_boolean ("copy-on-move",
+                "Copy on move",
+                "Whether children that only move are copied instead of repainted",
+                TRUE,
+                G_PARAM_READWRITE));
+
+    /**
+     * DdbSplitter:defer-allocation:
+     *
+     * Whether the child only gets a new size once in a while during rapid
+     * size changes, see #DdbSplitter:defer-interval. Until then it keeps
+     * its old size in a window of its own that follows the slot: cut off
+     * where the slot shrinks, so it never covers the handle or the other
+     * child, and padded with the background where the slot grows. Meant
+     * for panes that are expensive to lay out.
+     **/
+    gtk_container_class_install_child_property (gtkcontainer_class,
+            CHILD_PROP_DEFER_ALLOCATION,
+            g_param_spec_boolean ("defer-allocation",
+                "Defer allocation",
+                "Whether size changes of the child are deferred while resizing",
+                FALSE,
+                G_PARAM_READWRITE));
+
+    /**
+     * DdbSplitter:min-size:
+     *
+     * The smallest size of the child along the split, in pixels, as long
+     * as both children are shown. The minimum size request of the
+     * splitter includes it.
+     **/
+    gtk_container_class_install_child_property (gtkcontainer_class,
+            CHILD_PROP_MIN_SIZE,
+            g_param_spec_int ("min-size",
+                "Minimum size",
+                "The smallest size of the child along the split",
+                0,
+                G_MAXINT,
+                0,
+                G_PARAM_READWRITE));
+
+    /**
+     * DdbSplitter:max-size:
+     *
+     * The largest size of the child along the split, in pixels, or -1
+     * for no limit. #DdbSplitter:min-size wins when both can't be met.
+     **/
+    gtk_container_class_install_child_property (gtkcontainer_class,
+            CHILD_PROP_MAX_SIZE,
+            g_param_spec_int ("max-size",
+                "Maximum size",
+                "The largest size of the child along the split, -1 for no limit",
+                -1,
+                G_MAXINT,
+                -1,
+                G_PARAM_READWRITE));
+
+    /**
+     * DdbSplitter:min-fraction:
+     *
+     * The smallest share of the space next to the handle the child gets.
+     **/
+    gtk_container_class_install_child_property (gtkcontainer_class,
+            CHILD_PROP_MIN_FRACTION,
+            g_param_spec_float ("min-fraction",
+                "Minimum fraction",
+                "The smallest share of the space the child gets",
+                0.0f,
+                1.0f,
+                0.0f,
+                G_PARAM_READWRITE));
+
+    /**
+     * DdbSplitter:max-fraction:
+     *
+     * The largest share of the space next to the handle the child gets.
+     * 0 keeps the child as small as its minimums allow, the default of 1
+     * is no limit.
+     **/
+    gtk_container_class_install_child_property (gtkcontainer_class,
+            CHILD_PROP_MAX_FRACTION,
+            g_param_spec_float ("max-fraction",
+                "Maximum fraction",
+                "The largest share of the space the child gets",
+                0.0f,
+                1.0f,
+                1.0f,
+                G_PARAM_READWRITE));
+
+    /**
+     * DdbSplitter:shrink:
+     *
+     * Whether the child may get less than its size request, like the
+     * child property of the same name of #GtkPaned.
+     **/
+    gtk_container_class_install_child_property (gtkcontainer_class,
+            CHILD_PROP_SHRINK,
+            g_param_spec_boolean ("shrink",
+                "Shrink",
+                "Whether the child may get less than its size request",
+                TRUE,
+                G_PARAM_READWRITE));
 }
 
 static void
@@ -247,25 +729,182 @@ ddb_splitter_init (DdbSplitter *splitter)
     splitter->priv->orientation = GTK_ORIENTATION_HORIZONTAL;
     splitter->priv->size_mode = DDB_SPLITTER_SIZE_MODE_PROP;
     splitter->priv->drag_pos = -1;
+    splitter->priv->add_pos = -1;
     splitter->priv->in_drag = FALSE;
     splitter->priv->position_set = FALSE;
     splitter->priv->child1 = NULL;
     splitter->priv->child2 = NULL;
     splitter->priv->child1_size = 0;
     splitter->priv->child2_size = 0;
+    memset (splitter->priv->info, 0, sizeof (splitter->priv->info));
+    splitter->priv->defer_interval = 0;
+    splitter->priv->defer_id = 0;
+    splitter->priv->flush_deferred = FALSE;
     splitter->priv->handle = NULL;
     splitter->priv->handle_size = 5;
     splitter->priv->handle_pos.x = -1;
     splitter->priv->handle_pos.y = -1;
     splitter->priv->handle_pos.width = 5;
     splitter->priv->handle_pos.height = 5;
+    splitter->priv->handle_cache = NULL;
     splitter->priv->proportion = 0.5f;
+    splitter->priv->sync_group = NULL;
+    splitter->priv->anim_id = 0;
+    splitter->priv->heatmap = heatmap_default;
+    splitter->priv->heat_self_redraw = FALSE;
+    splitter->priv->heat_id = 0;
+    splitter->priv->heat_paint_id = 0;
+    splitter->priv->heat_slot = 0;
+    splitter->priv->heat_flash_until = 0;
+    splitter->priv->virtualize = FALSE;
+    splitter->priv->copy_on_move = TRUE;
+    splitter->priv->translating = FALSE;
+    splitter->priv->virtual_ancestor = FALSE;
+    splitter->priv->virtual_active = FALSE;
+    splitter->priv->virtual_adjustments[0] = NULL;
+    splitter->priv->virtual_adjustments[1] = NULL;
+    splitter->priv->active_child = 0;
+    splitter->priv->unrealize_timeout = -1;
+    splitter->priv->unrealize_id = 0;
+    splitter->priv->post_pending = 0;
+    splitter->priv->thrash_frame = -1;
+    splitter->priv->thrash_allocations = 0;
+    splitter->priv->thrash_reported = FALSE;
+    splitter->priv->thrash_child = -1;
+    splitter->priv->thrash_history_len[0] = 0;
+    splitter->priv->thrash_history_len[1] = 0;
+    memset (&splitter->priv->stats, 0, sizeof (DdbSplitterStats));
+    if (stats_dump) {
+        stats_splitters = g_list_prepend (stats_splitters, splitter);
+    }
     /* we don't provide our own window */
     gtk_widget_set_can_focus (GTK_WIDGET (splitter), FALSE);
     gtk_widget_set_has_window (GTK_WIDGET (splitter), FALSE);
     gtk_widget_set_redraw_on_allocate (GTK_WIDGET (splitter), FALSE);
 }
 
+static void
+ddb_splitter_stats_add (DdbSplitterStats *total, const DdbSplitterStats *stats)
+{
+    total->size_allocate_calls += stats->size_allocate_calls;
+    total->child_allocations += stats->child_allocations;
+    total->child_allocations_skipped += stats->child_allocations_skipped;
+    for (guint i = 0; i < DDB_SPLITTER_N_RESIZE_CAUSES; i++) {
+        total->resizes[i] += stats->resizes[i];
+    }
+    total->drag_motion_events += stats->drag_motion_events;
+    total->drag_motion_applied += stats->drag_motion_applied;
+    total->allocate_time += stats->allocate_time;
+    total->child_allocate_time += stats->child_allocate_time;
+    total->paint_time += stats->paint_time;
+    total->thrash_detections += stats->thrash_detections;
+    total->child_moves_copied += stats->child_moves_copied;
+}
+
+static void
+ddb_splitter_stats_print (const gchar *name, const DdbSplitterStats *stats)
+{
+    g_printerr ("%s: size_allocate %" G_GUINT64_FORMAT
+            ", child allocations %" G_GUINT64_FORMAT " (%" G_GUINT64_FORMAT " skipped)"
+            ", resizes proportion %" G_GUINT64_FORMAT " size-mode %" G_GUINT64_FORMAT
+            " orientation %" G_GUINT64_FORMAT " children %" G_GUINT64_FORMAT
+            " visibility %" G_GUINT64_FORMAT " layout %" G_GUINT64_FORMAT
+            ", drag motions %" G_GUINT64_FORMAT " (%" G_GUINT64_FORMAT " applied)"
+            ", allocate %.3f ms, children %.3f ms, paint %.3f ms"
+            ", thrash detections %" G_GUINT64_FORMAT
+            ", copied moves %" G_GUINT64_FORMAT "\n",
+            name,
+            stats->size_allocate_calls,
+            stats->child_allocations, stats->child_allocations_skipped,
+            stats->resizes[DDB_SPLITTER_RESIZE_CAUSE_PROPORTION],
+            stats->resizes[DDB_SPLITTER_RESIZE_CAUSE_SIZE_MODE],
+            stats->resizes[DDB_SPLITTER_RESIZE_CAUSE_ORIENTATION],
+            stats->resizes[DDB_SPLITTER_RESIZE_CAUSE_CHILDREN],
+            stats->resizes[DDB_SPLITTER_RESIZE_CAUSE_VISIBILITY],
+            stats->resizes[DDB_SPLITTER_RESIZE_CAUSE_LAYOUT],
+            stats->drag_motion_events, stats->drag_motion_applied,
+            stats->allocate_time / 1000.0,
+            stats->child_allocate_time / 1000.0,
+            stats->paint_time / 1000.0,
+            stats->thrash_detections,
+            stats->child_moves_copied);
+}
+
+/* Prints the statistics of all splitters, registered with atexit ()
+ * when DDB_SPLITTER_STATS is set */
+static void
+ddb_splitter_stats_dump (void)
+{
+    DdbSplitterStats total = stats_retired;
+
+    for (GList *l = stats_splitters; l; l = l->next) {
+        DdbSplitter *splitter = l->data;
+        gchar *name = g_strdup_printf ("DdbSplitter %p", (gpointer)splitter);
+        ddb_splitter_stats_print (name, &splitter->priv->stats);
+        ddb_splitter_stats_add (&total, &splitter->priv->stats);
+        g_free (name);
+    }
+    ddb_splitter_stats_print ("DdbSplitter destroyed", &stats_retired);
+    ddb_splitter_stats_print ("DdbSplitter total", &total);
+}
+
+/* Records a trace event for @splitter, along with how deeply it is
+ * nested in other splitters */
+static void
+ddb_splitter_trace (DdbSplitter *splitter, const gchar *name, gchar phase)
+{
+    guint depth = 0;
+
+    for (GtkWidget *w = gtk_widget_get_parent (GTK_WIDGET (splitter)); w; w = gtk_widget_get_parent (w)) {
+        if (DDB_IS_SPLITTER (w)) {
+            depth++;
+        }
+    }
+    _ddb_splitter_trace_event (name, phase, splitter, depth);
+}
+
+/* Queues a resize and records why */
+static void
+ddb_splitter_queue_resize (DdbSplitter *splitter, DdbSplitterResizeCause cause)
+{
+    splitter->priv->stats.resizes[cause]++;
+    gtk_widget_queue_resize (GTK_WIDGET (splitter));
+}
+
+static void
+ddb_splitter_dispose (GObject *object)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (object);
+
+    ddb_splitter_animation_remove (splitter);
+    ddb_splitter_set_sync_group (splitter, NULL);
+    if (splitter->priv->defer_id) {
+        g_source_remove (splitter->priv->defer_id);
+        splitter->priv->defer_id = 0;
+    }
+    if (splitter->priv->unrealize_id) {
+        g_source_remove (splitter->priv->unrealize_id);
+        splitter->priv->unrealize_id = 0;
+    }
+    ddb_splitter_heat_stop (splitter);
+    ddb_splitter_virtual_track (splitter, NULL, NULL);
+
+    G_OBJECT_CLASS (ddb_splitter_parent_class)->dispose (object);
+}
+
+static void
+ddb_splitter_finalize (GObject *object)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (object);
+
+    if (stats_dump) {
+        stats_splitters = g_list_remove (stats_splitters, splitter);
+        ddb_splitter_stats_add (&stats_retired, &splitter->priv->stats);
+    }
+
+    G_OBJECT_CLASS (ddb_splitter_parent_class)->finalize (object);
+}
+
 static void
 ddb_splitter_get_property (GObject *object,
                            guint prop_id,
@@ -288,6 +927,39 @@ ddb_splitter_get_property (GObject *object,
             g_value_set_float (value, ddb_splitter_get_proportion (splitter));
             break;
 
+        case PROP_LOCKED_SIZE:
+            g_value_set_int (value, ddb_splitter_get_locked_size (splitter));
+            break;
+
+        case PROP_SYNC_GROUP:
+            g_value_set_object (value, ddb_splitter_get_sync_group (splitter));
+            break;
+
+        case PROP_DEFER_INTERVAL:
+            g_value_set_uint (value, ddb_splitter_get_defer_interval (splitter));
+            break;
+
+        case PROP_ACTIVE_CHILD:
+            g_value_set_uint (value, ddb_splitter_get_active_child (splitter));
+            break;
+
+        case PROP_UNREALIZE_TIMEOUT:
+            g_value_set_int (value, ddb_splitter_get_unrealize_timeout (splitter));
+            break;
+
+
+        case PROP_HEATMAP:
+            g_value_set_boolean (value, ddb_splitter_get_heatmap (splitter));
+            break;
+
+        case PROP_VIRTUALIZE:
+            g_value_set_boolean (value, ddb_splitter_get_virtualize (splitter));
+            break;
+
+        case PROP_COPY_ON_MOVE:
+            g_value_set_boolean (value, ddb_splitter_get_copy_on_move (splitter));
+            break;
+
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
             break;
@@ -316,6 +988,39 @@ ddb_splitter_set_property (GObject *object,
             ddb_splitter_set_proportion (splitter, g_value_get_float (value));
             break;
 
+        case PROP_LOCKED_SIZE:
+            ddb_splitter_set_locked_size (splitter, g_value_get_int (value));
+            break;
+
+        case PROP_SYNC_GROUP:
+            ddb_splitter_set_sync_group (splitter, g_value_get_object (value));
+            break;
+
+        case PROP_DEFER_INTERVAL:
+            ddb_splitter_set_defer_interval (splitter, g_value_get_uint (value));
+            break;
+
+        case PROP_ACTIVE_CHILD:
+            ddb_splitter_set_active_child (splitter, g_value_get_uint (value));
+            break;
+
+        case PROP_UNREALIZE_TIMEOUT:
+            ddb_splitter_set_unrealize_timeout (splitter, g_value_get_int (value));
+            break;
+
+
+        case PROP_HEATMAP:
+            ddb_splitter_set_heatmap (splitter, g_value_get_boolean (value));
+            break;
+
+        case PROP_VIRTUALIZE:
+            ddb_splitter_set_virtualize (splitter, g_value_get_boolean (value));
+            break;
+
+        case PROP_COPY_ON_MOVE:
+            ddb_splitter_set_copy_on_move (splitter, g_value_get_boolean (value));
+            break;
+
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
             break;
@@ -349,6 +1054,8 @@ ddb_splitter_button_press (GtkWidget      *widget,
                     event->time) != GDK_GRAB_SUCCESS)
             return FALSE;
 
+        /* the handle stays where the animation left it */
+        ddb_splitter_stop_animation (splitter);
         splitter->priv->in_drag = TRUE;
         splitter->priv->grab_time = event->time;
 
@@ -439,25 +1146,28 @@ ddb_splitter_button_release (GtkWidget      *widget,
     return FALSE;
 }
 
+/* Moves the handle along with the pointer at @pos, relative to the
+ * splitter along the split */
 static void
-update_drag (DdbSplitter *splitter)
+update_drag (DdbSplitter *splitter, gint pos)
 {
-    gint pos;
     gint handle_size;
     gint size;
 
-    if (splitter->priv->orientation == GTK_ORIENTATION_HORIZONTAL)
-        gtk_widget_get_pointer (GTK_WIDGET (splitter), &pos, NULL);
-    else
-        gtk_widget_get_pointer (GTK_WIDGET (splitter), NULL, &pos);
-
     pos -= splitter->priv->drag_pos;
 
-    size = pos;
+    /* the pointer wins over an animation started during the drag */
+    ddb_splitter_animation_remove (splitter);
 
     GtkAllocation a;
+    DdbSplitterLayoutInput input;
     gtk_widget_get_allocation (GTK_WIDGET (splitter), &a);
+    ddb_splitter_layout_input (splitter, &a, &input);
+
+    /* keep both children within their limits */
+    size = ddb_splitter_layout_clamp (&input, pos);
     if (size != splitter->priv->child1_size) {
+        splitter->priv->stats.drag_motion_applied++;
         if (splitter->priv->orientation == GTK_ORIENTATION_HORIZONTAL) {
             ddb_splitter_set_proportion (splitter, CLAMP ((float)size/a.width, 0.0f, 1.0f));
         }
@@ -475,92 +1185,526 @@ ddb_splitter_motion (GtkWidget      *widget,
 
     if (splitter->priv->in_drag)
     {
-        update_drag (splitter);
+        gint x, y;
+        if (event->is_hint || event->window != splitter->priv->handle) {
+            gtk_widget_get_pointer (widget, &x, &y);
+        }
+        else {
+            /* the handle is placed in parent window coordinates */
+            GtkAllocation a;
+            gtk_widget_get_allocation (widget, &a);
+            x = (gint)event->x + splitter->priv->handle_pos.x - a.x;
+            y = (gint)event->y + splitter->priv->handle_pos.y - a.y;
+        }
+
+        splitter->priv->stats.drag_motion_events++;
+        DDB_SPLITTER_TRACE_BEGIN (splitter, "drag_motion");
+        update_drag (splitter, splitter->priv->orientation == GTK_ORIENTATION_HORIZONTAL ? x : y);
+        DDB_SPLITTER_TRACE_END (splitter, "drag_motion");
         return TRUE;
     }
 
     return FALSE;
 }
 
-#if GTK_CHECK_VERSION(3,0,0)
-static gboolean
-ddb_splitter_draw (GtkWidget *widget,
-                cairo_t   *cr)
+/* Advances the sliding second of the heat-map to @now, dropping the
+ * buckets that fell out of it */
+static void
+ddb_splitter_heat_advance (DdbSplitter *splitter, gint64 now)
 {
-    DdbSplitter *splitter = DDB_SPLITTER (widget);
+    DdbSplitterPrivate *priv = splitter->priv;
+    gint64 slot = now / DDB_SPLITTER_HEAT_BUCKET;
 
-    if (gtk_widget_get_visible (widget) && gtk_widget_get_mapped (widget) &&
-            splitter->priv->child1 && gtk_widget_get_visible (splitter->priv->child1) &&
-            splitter->priv->child2 && gtk_widget_get_visible (splitter->priv->child2))
-    {
-        if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_PROP) {
-            gtk_render_handle (gtk_widget_get_style_context (widget), cr,
-                    splitter->priv->handle_pos.x, splitter->priv->handle_pos.y,
-                    splitter->priv->handle_pos.width, splitter->priv->handle_pos.height);
-        }
-        else {
-            gtk_render_background (gtk_widget_get_style_context (widget), cr,
-                    splitter->priv->handle_pos.x, splitter->priv->handle_pos.y,
-                    splitter->priv->handle_pos.width, splitter->priv->handle_pos.height);
+    for (gint64 s = MAX (priv->heat_slot + 1, slot - DDB_SPLITTER_HEAT_BUCKETS + 1); s <= slot; s++) {
+        for (guint i = 0; i < 2; i++) {
+            priv->info[i].heat_allocations[s % DDB_SPLITTER_HEAT_BUCKETS] = 0;
+            priv->info[i].heat_paints[s % DDB_SPLITTER_HEAT_BUCKETS] = 0;
         }
     }
+    priv->heat_slot = MAX (priv->heat_slot, slot);
+}
 
-    /* Chain up to draw children */
-    GTK_WIDGET_CLASS (ddb_splitter_parent_class)->draw (widget, cr);
-
-    return FALSE;
+static guint
+ddb_splitter_heat_sum (const guint *buckets)
+{
+    guint sum = 0;
+    for (guint i = 0; i < DDB_SPLITTER_HEAT_BUCKETS; i++) {
+        sum += buckets[i];
+    }
+    return sum;
 }
 
-#else
+/* Redraws the overlay while it shows anything, so it fades out */
+/* The repaints of the overlay are over once the frame is painted */
+#if GTK_CHECK_VERSION(3,8,0)
+static void
+ddb_splitter_heat_painted (GdkFrameClock *clock, gpointer user_data)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (user_data);
 
+    g_signal_handler_disconnect (clock, splitter->priv->heat_paint_id);
+    splitter->priv->heat_paint_id = 0;
+    splitter->priv->heat_clock = NULL;
+    splitter->priv->heat_self_redraw = FALSE;
+}
+#else
 static gboolean
-ddb_splitter_expose (GtkWidget      *widget,
-                  GdkEventExpose *event)
+ddb_splitter_heat_painted (gpointer user_data)
 {
-    DdbSplitter *splitter = DDB_SPLITTER (widget);
-
-    if (gtk_widget_get_visible (widget) && gtk_widget_get_mapped (widget) &&
-            splitter->priv->child1 && gtk_widget_get_visible (splitter->priv->child1) &&
-            splitter->priv->child2 && gtk_widget_get_visible (splitter->priv->child2))
-    {
-        GtkStateType state;
-
-        if (gtk_widget_is_focus (widget))
-            state = GTK_STATE_SELECTED;
-        else
-            state = gtk_widget_get_state (widget);
-
-        //cairo_t *cr = gdk_cairo_create (gtk_widget_get_window (widget));
-        if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_PROP) {
-            gtk_paint_handle (gtk_widget_get_style (widget), gtk_widget_get_window (widget),
-                    state, GTK_SHADOW_NONE,
-                    &splitter->priv->handle_pos, widget, "paned",
-                    splitter->priv->handle_pos.x, splitter->priv->handle_pos.y,
-                    splitter->priv->handle_pos.width, splitter->priv->handle_pos.height,
-                    !splitter->priv->orientation);
-        }
-        else {
-            gtk_paint_box (gtk_widget_get_style (widget), gtk_widget_get_window (widget),
-                    state, GTK_SHADOW_NONE,
-                    &splitter->priv->handle_pos, widget, "paned",
-                    splitter->priv->handle_pos.x, splitter->priv->handle_pos.y,
-                    splitter->priv->handle_pos.width, splitter->priv->handle_pos.height);
-        }
-        //cairo_destroy (cr);
-    }
-
-    /* Chain up to draw children */
-    GTK_WIDGET_CLASS (ddb_splitter_parent_class)->expose_event (widget, event);
+    DdbSplitter *splitter = DDB_SPLITTER (user_data);
 
+    splitter->priv->heat_paint_id = 0;
+    splitter->priv->heat_self_redraw = FALSE;
     return FALSE;
 }
 #endif
 
+/* Repaints the overlay. The children have to repaint underneath it,
+ * which is not counted */
 static void
-ddb_splitter_realize (GtkWidget *widget)
+ddb_splitter_heat_redraw (DdbSplitter *splitter)
 {
-    GdkWindowAttr attributes;
-    gint attributes_mask;
+    DdbSplitterPrivate *priv = splitter->priv;
+    GtkWidget *widget = GTK_WIDGET (splitter);
+    GtkAllocation a;
+
+    gtk_widget_get_allocation (widget, &a);
+    priv->heat_self_redraw = TRUE;
+    gdk_window_invalidate_rect (gtk_widget_get_window (widget), &a, TRUE);
+
+    if (priv->heat_paint_id) {
+        return;
+    }
+#if GTK_CHECK_VERSION(3,8,0)
+    priv->heat_clock = gtk_widget_get_frame_clock (widget);
+    if (priv->heat_clock) {
+        priv->heat_paint_id = g_signal_connect (priv->heat_clock, "after-paint",
+                G_CALLBACK (ddb_splitter_heat_painted), splitter);
+    }
+#else
+    /* GDK paints at a higher priority than idle handlers */
+    priv->heat_paint_id = g_idle_add (ddb_splitter_heat_painted, splitter);
+#endif
+}
+
+static gboolean
+ddb_splitter_heat_timeout (gpointer user_data)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (user_data);
+    DdbSplitterPrivate *priv = splitter->priv;
+    gint64 now = g_get_monotonic_time ();
+
+    ddb_splitter_heat_advance (splitter, now);
+    if (gtk_widget_get_realized (GTK_WIDGET (splitter))) {
+        ddb_splitter_heat_redraw (splitter);
+    }
+
+    for (guint i = 0; i < 2; i++) {
+        if (ddb_splitter_heat_sum (priv->info[i].heat_allocations)
+                || ddb_splitter_heat_sum (priv->info[i].heat_paints)) {
+            return TRUE;
+        }
+    }
+    if (now < priv->heat_flash_until) {
+        return TRUE;
+    }
+    priv->heat_id = 0;
+    return FALSE;
+}
+
+static void
+ddb_splitter_heat_kick (DdbSplitter *splitter)
+{
+    if (!splitter->priv->heat_id && gtk_widget_get_mapped (GTK_WIDGET (splitter))) {
+        splitter->priv->heat_id = g_timeout_add (DDB_SPLITTER_HEAT_BUCKET / 1000, ddb_splitter_heat_timeout, splitter);
+    }
+}
+
+static void
+ddb_splitter_heat_stop (DdbSplitter *splitter)
+{
+    if (splitter->priv->heat_id) {
+        g_source_remove (splitter->priv->heat_id);
+        splitter->priv->heat_id = 0;
+    }
+    if (splitter->priv->heat_paint_id) {
+#if GTK_CHECK_VERSION(3,8,0)
+        g_signal_handler_disconnect (splitter->priv->heat_clock, splitter->priv->heat_paint_id);
+        splitter->priv->heat_clock = NULL;
+#else
+        g_source_remove (splitter->priv->heat_paint_id);
+#endif
+        splitter->priv->heat_paint_id = 0;
+    }
+    splitter->priv->heat_self_redraw = FALSE;
+}
+
+static void
+ddb_splitter_heat_record_allocation (DdbSplitter *splitter, guint pos, gint64 elapsed)
+{
+    DdbSplitterChildInfo *info = &splitter->priv->info[pos];
+    gint64 now = g_get_monotonic_time ();
+
+    ddb_splitter_heat_advance (splitter, now);
+    info->heat_allocations[(now / DDB_SPLITTER_HEAT_BUCKET) % DDB_SPLITTER_HEAT_BUCKETS]++;
+    info->heat_allocate_time = elapsed;
+    ddb_splitter_heat_kick (splitter);
+}
+
+static void
+ddb_splitter_heat_flash_handle (DdbSplitter *splitter)
+{
+    splitter->priv->heat_flash_until = g_get_monotonic_time () + DDB_SPLITTER_HEAT_FLASH;
+    ddb_splitter_heat_kick (splitter);
+}
+
+/* Tints the child in slot @pos by how often it was allocated and
+ * repainted, with the child at @x, @y in @cr */
+static void
+ddb_splitter_heat_draw_child (DdbSplitter *splitter, guint pos, cairo_t *cr, gint x, gint y, gint width, gint height)
+{
+    DdbSplitterChildInfo *info = &splitter->priv->info[pos];
+    guint allocations = ddb_splitter_heat_sum (info->heat_allocations);
+    guint paints = ddb_splitter_heat_sum (info->heat_paints);
+
+    cairo_save (cr);
+    cairo_rectangle (cr, x, y, width, height);
+    cairo_set_source_rgba (cr, 1.0, 0.0, 0.0, MIN (0.5, allocations * 0.02));
+    cairo_fill_preserve (cr);
+    cairo_set_source_rgba (cr, 0.0, 0.0, 1.0, MIN (0.5, paints * 0.02));
+    cairo_fill (cr);
+
+    gchar *text = g_strdup_printf ("%u alloc/s  %u paint/s  %.2f ms",
+            allocations, paints, info->heat_allocate_time / 1000.0);
+    cairo_set_font_size (cr, 10);
+    cairo_set_source_rgba (cr, 0.0, 0.0, 0.0, 0.8);
+    cairo_move_to (cr, x + 4, y + 12);
+    cairo_show_text (cr, text);
+    g_free (text);
+    cairo_restore (cr);
+}
+
+/* Counts the repaints of a child, except the ones caused by the overlay,
+ * and draws the overlay on top of what the child drew. Drawing from here
+ * reaches the windows of the child as well, which would cover anything
+ * the splitter draws. */
+static gboolean
+ddb_splitter_heat_child_draw (GtkWidget *child, gpointer event_or_cr, gpointer user_data)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (user_data);
+    gint pos = ddb_splitter_child_pos (splitter, child);
+    GtkAllocation a;
+
+    if (pos < 0) {
+        return FALSE;
+    }
+    gint64 now = g_get_monotonic_time ();
+    ddb_splitter_heat_advance (splitter, now);
+    if (!splitter->priv->heat_self_redraw) {
+        splitter->priv->info[pos].heat_paints[(now / DDB_SPLITTER_HEAT_BUCKET) % DDB_SPLITTER_HEAT_BUCKETS]++;
+        ddb_splitter_heat_kick (splitter);
+    }
+
+    gtk_widget_get_allocation (child, &a);
+#if GTK_CHECK_VERSION(3,0,0)
+    /* cr is relative to the child, whichever of its windows is drawn */
+    ddb_splitter_heat_draw_child (splitter, pos, event_or_cr, 0, 0, a.width, a.height);
+#else
+    GdkEventExpose *event = event_or_cr;
+    GdkWindow *window = event->window;
+    gint x = gtk_widget_get_has_window (child) ? 0 : a.x;
+    gint y = gtk_widget_get_has_window (child) ? 0 : a.y;
+
+    /* from the window of the child to the one exposed */
+    while (window && window != gtk_widget_get_window (child)) {
+        gint wx, wy;
+        gdk_window_get_position (window, &wx, &wy);
+        x -= wx;
+        y -= wy;
+        window = gdk_window_get_parent (window);
+    }
+    if (window) {
+        cairo_t *cr = gdk_cairo_create (event->window);
+        gdk_cairo_region (cr, event->region);
+        cairo_clip (cr);
+        ddb_splitter_heat_draw_child (splitter, pos, cr, x, y, a.width, a.height);
+        cairo_destroy (cr);
+    }
+#endif
+    return FALSE;
+}
+
+static void
+ddb_splitter_heat_connect (DdbSplitter *splitter, guint pos)
+{
+    GtkWidget *child = pos == 0 ? splitter->priv->child1 : splitter->priv->child2;
+    DdbSplitterChildInfo *info = &splitter->priv->info[pos];
+
+    if (child && !info->heat_draw_id) {
+#if GTK_CHECK_VERSION(3,0,0)
+        info->heat_draw_id = g_signal_connect_after (child, "draw", G_CALLBACK (ddb_splitter_heat_child_draw), splitter);
+#else
+        info->heat_draw_id = g_signal_connect_after (child, "expose-event", G_CALLBACK (ddb_splitter_heat_child_draw), splitter);
+#endif
+    }
+}
+
+static void
+ddb_splitter_heat_disconnect (DdbSplitter *splitter, guint pos)
+{
+    GtkWidget *child = pos == 0 ? splitter->priv->child1 : splitter->priv->child2;
+    DdbSplitterChildInfo *info = &splitter->priv->info[pos];
+
+    if (child && info->heat_draw_id) {
+        g_signal_handler_disconnect (child, info->heat_draw_id);
+    }
+    info->heat_draw_id = 0;
+}
+
+/* Flashes the handle after it moved, @dx and @dy translate from parent
+ * window coordinates to the ones of @cr. The children draw their part of
+ * the overlay themselves. */
+static void
+ddb_splitter_heat_draw (DdbSplitter *splitter, cairo_t *cr, gint dx, gint dy)
+{
+    DdbSplitterPrivate *priv = splitter->priv;
+    gint64 now = g_get_monotonic_time ();
+
+    if (now < priv->heat_flash_until && ddb_splitter_handle_visible (GTK_WIDGET (splitter))) {
+        gdouble alpha = 0.8 * (priv->heat_flash_until - now) / DDB_SPLITTER_HEAT_FLASH;
+        cairo_save (cr);
+        cairo_rectangle (cr, priv->handle_pos.x - dx, priv->handle_pos.y - dy,
+                priv->handle_pos.width, priv->handle_pos.height);
+        cairo_set_source_rgba (cr, 1.0, 0.8, 0.0, alpha);
+        cairo_fill (cr);
+        cairo_restore (cr);
+    }
+}
+
+static void
+ddb_splitter_handle_cache_clear (DdbSplitter *splitter)
+{
+    if (splitter->priv->handle_cache) {
+#if GTK_CHECK_VERSION(3,0,0)
+        cairo_surface_destroy (splitter->priv->handle_cache);
+#else
+        g_object_unref (splitter->priv->handle_cache);
+#endif
+        splitter->priv->handle_cache = NULL;
+    }
+}
+
+/* Whether the cached handle still looks like the one to be painted */
+static gboolean
+ddb_splitter_handle_cache_valid (DdbSplitter *splitter, gint state)
+{
+    DdbSplitterPrivate *priv = splitter->priv;
+
+    return priv->handle_cache
+        && priv->handle_cache_width == priv->handle_pos.width
+        && priv->handle_cache_height == priv->handle_pos.height
+        && priv->handle_cache_state == state
+        && priv->handle_cache_orientation == priv->orientation
+        && priv->handle_cache_size_mode == priv->size_mode;
+}
+
+static void
+ddb_splitter_handle_cache_update (DdbSplitter *splitter, gint state)
+{
+    DdbSplitterPrivate *priv = splitter->priv;
+
+    priv->handle_cache_width = priv->handle_pos.width;
+    priv->handle_cache_height = priv->handle_pos.height;
+    priv->handle_cache_state = state;
+    priv->handle_cache_orientation = priv->orientation;
+    priv->handle_cache_size_mode = priv->size_mode;
+}
+
+static gboolean
+ddb_splitter_handle_visible (GtkWidget *widget)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (widget);
+
+    return gtk_widget_get_visible (widget) && gtk_widget_get_mapped (widget) &&
+            splitter->priv->size_mode != DDB_SPLITTER_SIZE_MODE_STACK &&
+            splitter->priv->child1 && gtk_widget_get_visible (splitter->priv->child1) &&
+            splitter->priv->child2 && gtk_widget_get_visible (splitter->priv->child2) &&
+            splitter->priv->handle_pos.width > 0 && splitter->priv->handle_pos.height > 0;
+}
+
+#if GTK_CHECK_VERSION(3,0,0)
+static gboolean
+ddb_splitter_draw (GtkWidget *widget,
+                cairo_t   *cr)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (widget);
+    GdkRectangle clip;
+    gint64 start = g_get_monotonic_time ();
+    DDB_SPLITTER_TRACE_BEGIN (splitter, "paint_handle");
+
+    GtkAllocation a;
+    gtk_widget_get_allocation (widget, &a);
+
+    for (guint i = 0; i < 2; i++) {
+        /* pad children that keep a smaller size in their clip window */
+        DdbSplitterChildInfo *info = &splitter->priv->info[i];
+        if (info->clip && gtk_cairo_should_draw_window (cr, info->clip)) {
+            gtk_render_background (gtk_widget_get_style_context (widget), cr,
+                    info->allocation.x - a.x, info->allocation.y - a.y,
+                    info->allocation.width, info->allocation.height);
+        }
+    }
+
+    if (ddb_splitter_handle_visible (widget)
+            && gtk_cairo_should_draw_window (cr, gtk_widget_get_window (widget)))
+    {
+        /* handle_pos is in parent window coordinates, cr in ours */
+        GdkRectangle handle = splitter->priv->handle_pos;
+        handle.x -= a.x;
+        handle.y -= a.y;
+
+        /* skip the handle when only a child is redrawn */
+        if (!gdk_cairo_get_clip_rectangle (cr, &clip)
+                || gdk_rectangle_intersect (&clip, &handle, NULL)) {
+            GtkStateFlags state = gtk_widget_get_state_flags (widget);
+
+            if (!ddb_splitter_handle_cache_valid (splitter, state)) {
+                ddb_splitter_handle_cache_clear (splitter);
+                splitter->priv->handle_cache = gdk_window_create_similar_surface (gtk_widget_get_window (widget),
+                        CAIRO_CONTENT_COLOR_ALPHA, handle.width, handle.height);
+
+                cairo_t *cache_cr = cairo_create (splitter->priv->handle_cache);
+                if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_PROP) {
+                    gtk_render_handle (gtk_widget_get_style_context (widget), cache_cr,
+                            0, 0, handle.width, handle.height);
+                }
+                else {
+                    gtk_render_background (gtk_widget_get_style_context (widget), cache_cr,
+                            0, 0, handle.width, handle.height);
+                }
+                cairo_destroy (cache_cr);
+                ddb_splitter_handle_cache_update (splitter, state);
+            }
+
+            cairo_save (cr);
+            cairo_set_source_surface (cr, splitter->priv->handle_cache, handle.x, handle.y);
+            cairo_rectangle (cr, handle.x, handle.y, handle.width, handle.height);
+            cairo_fill (cr);
+            cairo_restore (cr);
+        }
+    }
+    splitter->priv->stats.paint_time += g_get_monotonic_time () - start;
+    DDB_SPLITTER_TRACE_END (splitter, "paint_handle");
+
+    /* Chain up to draw children */
+    GTK_WIDGET_CLASS (ddb_splitter_parent_class)->draw (widget, cr);
+
+    if (G_UNLIKELY (splitter->priv->heatmap) && gtk_cairo_should_draw_window (cr, gtk_widget_get_window (widget))) {
+        ddb_splitter_heat_draw (splitter, cr, a.x, a.y);
+    }
+
+    return FALSE;
+}
+
+static void
+ddb_splitter_style_updated (GtkWidget *widget)
+{
+    ddb_splitter_handle_cache_clear (DDB_SPLITTER (widget));
+
+    GTK_WIDGET_CLASS (ddb_splitter_parent_class)->style_updated (widget);
+}
+
+#else
+
+static gboolean
+ddb_splitter_expose (GtkWidget      *widget,
+                  GdkEventExpose *event)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (widget);
+    gint64 start = g_get_monotonic_time ();
+    DDB_SPLITTER_TRACE_BEGIN (splitter, "paint_handle");
+
+    /* skip the handle when only a child is redrawn */
+    if (ddb_splitter_handle_visible (widget) && event->window == gtk_widget_get_window (widget)
+            && gdk_region_rect_in (event->region, &splitter->priv->handle_pos) != GDK_OVERLAP_RECTANGLE_OUT)
+    {
+        GtkStateType state;
+        GtkStyle *style = gtk_widget_get_style (widget);
+        GdkRectangle *handle = &splitter->priv->handle_pos;
+
+        if (gtk_widget_is_focus (widget))
+            state = GTK_STATE_SELECTED;
+        else
+            state = gtk_widget_get_state (widget);
+
+        if (!ddb_splitter_handle_cache_valid (splitter, state)) {
+            ddb_splitter_handle_cache_clear (splitter);
+            splitter->priv->handle_cache = gdk_pixmap_new (gtk_widget_get_window (widget),
+                    handle->width, handle->height, -1);
+
+            /* themes draw the handle over the background of the window */
+            gdk_draw_rectangle (splitter->priv->handle_cache, style->bg_gc[state], TRUE,
+                    0, 0, handle->width, handle->height);
+            if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_PROP) {
+                gtk_paint_handle (style, splitter->priv->handle_cache,
+                        state, GTK_SHADOW_NONE,
+                        NULL, widget, "paned",
+                        0, 0, handle->width, handle->height,
+                        !splitter->priv->orientation);
+            }
+            else {
+                gtk_paint_box (style, splitter->priv->handle_cache,
+                        state, GTK_SHADOW_NONE,
+                        NULL, widget, "paned",
+                        0, 0, handle->width, handle->height);
+            }
+            ddb_splitter_handle_cache_update (splitter, state);
+        }
+
+        gdk_draw_drawable (gtk_widget_get_window (widget), style->bg_gc[state],
+                splitter->priv->handle_cache, 0, 0,
+                handle->x, handle->y, handle->width, handle->height);
+    }
+    splitter->priv->stats.paint_time += g_get_monotonic_time () - start;
+    DDB_SPLITTER_TRACE_END (splitter, "paint_handle");
+
+    /* Chain up to draw children */
+    GTK_WIDGET_CLASS (ddb_splitter_parent_class)->expose_event (widget, event);
+
+    if (G_UNLIKELY (splitter->priv->heatmap) && event->window == gtk_widget_get_window (widget)) {
+        cairo_t *cr = gdk_cairo_create (event->window);
+        gdk_cairo_region (cr, event->region);
+        cairo_clip (cr);
+        ddb_splitter_heat_draw (splitter, cr, 0, 0);
+        cairo_destroy (cr);
+    }
+
+    return FALSE;
+}
+
+static void
+ddb_splitter_style_set (GtkWidget *widget,
+                        GtkStyle  *previous_style)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (widget);
+
+    ddb_splitter_handle_cache_clear (splitter);
+    for (guint i = 0; i < 2; i++) {
+        if (splitter->priv->info[i].clip) {
+            gtk_style_set_background (gtk_widget_get_style (widget), splitter->priv->info[i].clip, GTK_STATE_NORMAL);
+        }
+    }
+
+    if (GTK_WIDGET_CLASS (ddb_splitter_parent_class)->style_set)
+        GTK_WIDGET_CLASS (ddb_splitter_parent_class)->style_set (widget, previous_style);
+}
+#endif
+
+static void
+ddb_splitter_realize (GtkWidget *widget)
+{
+    GdkWindowAttr attributes;
+    gint attributes_mask;
 
     gtk_widget_set_realized (widget, TRUE);
     DdbSplitter *splitter = DDB_SPLITTER (widget);
@@ -608,8 +1752,12 @@ ddb_splitter_realize (GtkWidget *widget)
         //widget->style = gtk_style_attach (widget->style, widget->window);
 
         if (splitter->priv->child1 && gtk_widget_get_visible (splitter->priv->child1) &&
-                splitter->priv->child2 && gtk_widget_get_visible (splitter->priv->child2))
+                splitter->priv->child2 && gtk_widget_get_visible (splitter->priv->child2) &&
+                splitter->priv->size_mode != DDB_SPLITTER_SIZE_MODE_STACK)
             gdk_window_show (splitter->priv->handle);
+
+        ddb_splitter_clip_update (splitter, 0);
+        ddb_splitter_clip_update (splitter, 1);
     }
 }
 
@@ -618,6 +1766,8 @@ ddb_splitter_unrealize (GtkWidget *widget)
 {
     DdbSplitter *splitter = DDB_SPLITTER (widget);
 
+    ddb_splitter_handle_cache_clear (splitter);
+
     if (splitter->priv->handle)
     {
         gdk_window_set_user_data (splitter->priv->handle, NULL);
@@ -626,6 +1776,10 @@ ddb_splitter_unrealize (GtkWidget *widget)
     }
 
     GTK_WIDGET_CLASS (ddb_splitter_parent_class)->unrealize (widget);
+
+    /* the children are unrealized by now, nothing is left in there */
+    ddb_splitter_clip_remove (splitter, 0);
+    ddb_splitter_clip_remove (splitter, 1);
 }
 
 static void
@@ -633,7 +1787,8 @@ ddb_splitter_map (GtkWidget *widget)
 {
     DdbSplitter *splitter = DDB_SPLITTER (widget);
 
-    gdk_window_show (splitter->priv->handle);
+    if (splitter->priv->size_mode != DDB_SPLITTER_SIZE_MODE_STACK)
+        gdk_window_show (splitter->priv->handle);
 
     GTK_WIDGET_CLASS (ddb_splitter_parent_class)->map (widget);
 }
@@ -643,55 +1798,155 @@ ddb_splitter_unmap (GtkWidget *widget)
 {
     DdbSplitter *splitter = DDB_SPLITTER (widget);
 
+    if (splitter->priv->anim_id) {
+        /* no frames while unmapped, jump to the end */
+        splitter->priv->anim_duration = 0;
+        ddb_splitter_animation_step (splitter, 0);
+    }
+
     gdk_window_hide (splitter->priv->handle);
+    ddb_splitter_heat_stop (splitter);
 
     GTK_WIDGET_CLASS (ddb_splitter_parent_class)->unmap (widget);
 }
 
+/* Drops a ready hint once the child's own request along @axis differs
+ * from the one it had when the hint became ready */
+static void
+ddb_splitter_child_size_hint_check (DdbSplitterChildInfo *info, guint axis, gint size)
+{
+    if (info->size_pending || !info->size_hinted) {
+        return;
+    }
+    if (info->size_hint_basis[axis] < 0) {
+        info->size_hint_basis[axis] = size;
+    }
+    else if (info->size_hint_basis[axis] != size) {
+        info->size_hinted = FALSE;
+    }
+}
+
+/* The smallest space next to the handle that meets the minimums of both
+ * children, @request holds their size requests along the split */
+static gint
+ddb_splitter_min_space (DdbSplitter *splitter, const gint request[2])
+{
+    DdbSplitterPrivate *priv = splitter->priv;
+    gint size[2];
+    gfloat fraction[2];
+
+    for (guint i = 0; i < 2; i++) {
+        size[i] = MAX (priv->info[i].min_size, priv->info[i].shrink ? 0 : request[i]);
+        fraction[i] = priv->info[i].min_fraction;
+    }
+
+    gint space = size[0] + size[1];
+    if (fraction[0] + fraction[1] < 1.0f) {
+        /* one child takes its fraction, the other one needs the rest */
+        space = MAX (space, (gint)ceilf (size[1] / (1.0f - fraction[0])));
+        space = MAX (space, (gint)ceilf (size[0] / (1.0f - fraction[1])));
+    }
+    return space;
+}
+
 #if !GTK_CHECK_VERSION(3,0,0)
+/* Queries the size request of the child in slot @pos, and replaces it by
+ * the hint given for it as long as that applies */
+static void
+ddb_splitter_child_size_request (DdbSplitter *splitter, guint pos, GtkRequisition *requisition)
+{
+    DdbSplitterChildInfo *info = &splitter->priv->info[pos];
+
+    gtk_widget_size_request (pos == 0 ? splitter->priv->child1 : splitter->priv->child2, requisition);
+    ddb_splitter_child_size_hint_check (info, 0, requisition->width);
+    ddb_splitter_child_size_hint_check (info, 1, requisition->height);
+    if (info->size_pending || info->size_hinted) {
+        *requisition = info->size_hint;
+    }
+}
+
 static void
 ddb_splitter_size_request (GtkWidget      *widget,
         GtkRequisition *requisition)
 {
     DdbSplitter *splitter = DDB_SPLITTER (widget);
+    DDB_SPLITTER_TRACE_BEGIN (splitter, "size_request");
 
     gint border_width = 0;
     GtkRequisition req_c1;
     req_c1.width = 0;
     req_c1.height = 0;
     if (splitter->priv->child1 && gtk_widget_get_visible (splitter->priv->child1)) {
-        gtk_widget_size_request (splitter->priv->child1, &req_c1);
+        ddb_splitter_child_size_request (splitter, 0, &req_c1);
     }
 
     GtkRequisition req_c2;
     req_c2.width = 0;
     req_c2.height = 0;
     if (splitter->priv->child2 && gtk_widget_get_visible (splitter->priv->child2)) {
-        gtk_widget_size_request (splitter->priv->child2, &req_c2);
+        ddb_splitter_child_size_request (splitter, 1, &req_c2);
     }
 
     requisition->width += border_width * 2;
     requisition->height += border_width * 2;
 
-    if (splitter->priv->orientation == GTK_ORIENTATION_HORIZONTAL) {
-        requisition->width += req_c1.width + req_c2.width;
+    gboolean split = splitter->priv->child1 && gtk_widget_get_visible (splitter->priv->child1) &&
+            splitter->priv->child2 && gtk_widget_get_visible (splitter->priv->child2) &&
+            splitter->priv->size_mode != DDB_SPLITTER_SIZE_MODE_STACK;
+
+    if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_STACK) {
+        /* both children fit, so switching doesn't need a resize */
+        requisition->width += MAX (req_c1.width, req_c2.width);
+        requisition->height += MAX (req_c1.height, req_c2.height);
+    }
+    else if (splitter->priv->orientation == GTK_ORIENTATION_HORIZONTAL) {
+        gint request[2] = { req_c1.width, req_c2.width };
+        requisition->width += split ? MAX (req_c1.width + req_c2.width, ddb_splitter_min_space (splitter, request))
+            : req_c1.width + req_c2.width;
         requisition->height += MAX (req_c1.height, req_c2.height);
     }
     else {
+        gint request[2] = { req_c1.height, req_c2.height };
         requisition->width += MAX (req_c1.width, req_c2.width);
-        requisition->height += req_c1.height + req_c2.height;
+        requisition->height += split ? MAX (req_c1.height + req_c2.height, ddb_splitter_min_space (splitter, request))
+            : req_c1.height + req_c2.height;
     }
 
-    if (splitter->priv->child1 && gtk_widget_get_visible (splitter->priv->child1) &&
-            splitter->priv->child2 && gtk_widget_get_visible (splitter->priv->child2))
+    if (split)
     {
         if (splitter->priv->orientation == GTK_ORIENTATION_HORIZONTAL)
             requisition->width += 5;
         else
             requisition->height += 5;
     }
+    DDB_SPLITTER_TRACE_END (splitter, "size_request");
 }
 #else
+/* Queries the size request of the child in slot @pos along @orientation,
+ * and replaces it by the hint given for it as long as that applies. The
+ * child is always queried, GTK expects that before it is allocated. */
+static void
+ddb_splitter_child_preferred_size (DdbSplitter *splitter,
+                                   guint pos,
+                                   GtkOrientation orientation,
+                                   gint *minimum,
+                                   gint *natural)
+{
+    DdbSplitterChildInfo *info = &splitter->priv->info[pos];
+    GtkWidget *child = pos == 0 ? splitter->priv->child1 : splitter->priv->child2;
+
+    if (orientation == GTK_ORIENTATION_HORIZONTAL) {
+        gtk_widget_get_preferred_width (child, minimum, natural);
+    }
+    else {
+        gtk_widget_get_preferred_height (child, minimum, natural);
+    }
+    ddb_splitter_child_size_hint_check (info, orientation == GTK_ORIENTATION_HORIZONTAL ? 0 : 1, *minimum);
+    if (info->size_pending || info->size_hinted) {
+        *minimum = *natural = orientation == GTK_ORIENTATION_HORIZONTAL ? info->size_hint.width : info->size_hint.height;
+    }
+}
+
 static void
 ddb_splitter_get_preferred_width (GtkWidget *widget,
                                gint *minimum,
@@ -704,18 +1959,23 @@ ddb_splitter_get_preferred_width (GtkWidget *widget,
     gint child1_nat = 0;
     gint child2_min = 0;
     gint child2_nat = 0;
+    DDB_SPLITTER_TRACE_BEGIN (splitter, "size_request");
 
     if (splitter->priv->child1 && gtk_widget_get_visible (splitter->priv->child1)) {
-        gtk_widget_get_preferred_width (splitter->priv->child1, &child1_min, &child2_nat);
+        ddb_splitter_child_preferred_size (splitter, 0, GTK_ORIENTATION_HORIZONTAL, &child1_min, &child1_nat);
     }
     if (splitter->priv->child2 && gtk_widget_get_visible (splitter->priv->child2)) {
-        gtk_widget_get_preferred_width (splitter->priv->child2, &child2_min, &child2_nat);
+        ddb_splitter_child_preferred_size (splitter, 1, GTK_ORIENTATION_HORIZONTAL, &child2_min, &child2_nat);
     }
 
-    if (splitter->priv->orientation == GTK_ORIENTATION_HORIZONTAL) {
+    if (splitter->priv->orientation == GTK_ORIENTATION_HORIZONTAL
+            && splitter->priv->size_mode != DDB_SPLITTER_SIZE_MODE_STACK) {
         nat = child1_nat + child2_nat;
         if (splitter->priv->child1 && gtk_widget_get_visible (splitter->priv->child1)
                 && splitter->priv->child2 && gtk_widget_get_visible (splitter->priv->child2)) {
+            gint request[2] = { child1_min, child2_min };
+            min = ddb_splitter_min_space (splitter, request);
+            nat = MAX (nat, min);
             min += splitter->priv->handle_size;
             nat += splitter->priv->handle_size;
         }
@@ -725,6 +1985,7 @@ ddb_splitter_get_preferred_width (GtkWidget *widget,
     }
     *minimum = min;
     *natural = nat;
+    DDB_SPLITTER_TRACE_END (splitter, "size_request");
 }
 
 static void
@@ -739,18 +2000,23 @@ ddb_splitter_get_preferred_height (GtkWidget *widget,
     gint child1_nat = 0;
     gint child2_min = 0;
     gint child2_nat = 0;
+    DDB_SPLITTER_TRACE_BEGIN (splitter, "size_request");
 
     if (splitter->priv->child1 && gtk_widget_get_visible (splitter->priv->child1)) {
-        gtk_widget_get_preferred_height (splitter->priv->child1, &child1_min, &child2_nat);
+        ddb_splitter_child_preferred_size (splitter, 0, GTK_ORIENTATION_VERTICAL, &child1_min, &child1_nat);
     }
     if (splitter->priv->child2 && gtk_widget_get_visible (splitter->priv->child2)) {
-        gtk_widget_get_preferred_height (splitter->priv->child2, &child2_min, &child2_nat);
+        ddb_splitter_child_preferred_size (splitter, 1, GTK_ORIENTATION_VERTICAL, &child2_min, &child2_nat);
     }
 
-    if (splitter->priv->orientation == GTK_ORIENTATION_VERTICAL) {
+    if (splitter->priv->orientation == GTK_ORIENTATION_VERTICAL
+            && splitter->priv->size_mode != DDB_SPLITTER_SIZE_MODE_STACK) {
         nat = child1_nat + child2_nat;
         if (splitter->priv->child1 && gtk_widget_get_visible (splitter->priv->child1)
                 && splitter->priv->child2 && gtk_widget_get_visible (splitter->priv->child2)) {
+            gint request[2] = { child1_min, child2_min };
+            min = ddb_splitter_min_space (splitter, request);
+            nat = MAX (nat, min);
             min += splitter->priv->handle_size;
             nat += splitter->priv->handle_size;
         }
@@ -760,6 +2026,7 @@ ddb_splitter_get_preferred_height (GtkWidget *widget,
     }
     *minimum = min;
     *natural = nat;
+    DDB_SPLITTER_TRACE_END (splitter, "size_request");
 }
 
 static void
@@ -781,457 +2048,3128 @@ ddb_splitter_get_preferred_height_for_width (GtkWidget *widget,
 }
 #endif
 
+static gint
+ddb_splitter_child_pos (DdbSplitter *splitter, GtkWidget *child)
+{
+    if (child && child == splitter->priv->child1) {
+        return 0;
+    }
+    if (child && child == splitter->priv->child2) {
+        return 1;
+    }
+    return -1;
+}
+
 static void
-ddb_splitter_size_allocate (GtkWidget *widget, GtkAllocation *allocation)
+ddb_splitter_get_child_property (GtkContainer *container,
+                                 GtkWidget *child,
+                                 guint prop_id,
+                                 GValue *value,
+                                 GParamSpec *pspec)
 {
-    DdbSplitter *splitter = DDB_SPLITTER (widget);
-    GtkWidget *c1 = splitter->priv->child1;
-    GtkWidget *c2 = splitter->priv->child2;
-    // TODO: consider border width
-    gint border_width = 0;
-    gtk_widget_set_allocation (widget, allocation);
+    DdbSplitter *splitter = DDB_SPLITTER (container);
+    gint pos = ddb_splitter_child_pos (splitter, child);
+    g_return_if_fail (pos >= 0);
 
-    gboolean child1_visible = c1 && gtk_widget_get_visible (c1) ? TRUE : FALSE;
-    gboolean child2_visible = c2 && gtk_widget_get_visible (c2) ? TRUE : FALSE;
-    guint num_visible_children = child1_visible + child2_visible;
+    switch (prop_id)
+    {
+        case CHILD_PROP_DEFER_ALLOCATION:
+            g_value_set_boolean (value, splitter->priv->info[pos].defer_allocation);
+            break;
 
-    gint con_width = allocation->width - border_width * 2;
-    gint con_height = allocation->height - border_width * 2;
-    gint handle_size = 0;
+        case CHILD_PROP_MIN_SIZE:
+            g_value_set_int (value, splitter->priv->info[pos].min_size);
+            break;
 
-    GdkRectangle old_handle_pos = splitter->priv->handle_pos;
+        case CHILD_PROP_MAX_SIZE:
+            g_value_set_int (value, splitter->priv->info[pos].max_size);
+            break;
 
-    GtkAllocation child1_allocation;
-    GtkAllocation child2_allocation;
-    if (splitter->priv->orientation == GTK_ORIENTATION_HORIZONTAL) {
-        handle_size = num_visible_children > 1 ? splitter->priv->handle_size : 0;
-        if (child1_visible) {
-            // use full height in horitzontal splitter
-            child1_allocation.height = MAX (1, con_height);
-
-            gint width = 0;
-            if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_LOCK_C1) {
-                // child 1 locked, use saved size
-                width = splitter->priv->child1_size;
-            }
-            else {
-                if (num_visible_children == 1) {
-                    // only one child, use full width
-                    width = con_width;
-                }
-                else if (child2_visible && splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_LOCK_C2) {
-                    // two children and second one is locked, use all space left
-                    width = con_width - splitter->priv->child2_size - handle_size;
-                }
-                else {
-                    // two children visible and proportional scaling is active
-                    width = (con_width - handle_size) * splitter->priv->proportion;
-                }
-            }
-            child1_allocation.width = MAX (1, width);
-            child1_allocation.x =allocation->x + border_width;
-            child1_allocation.y = allocation->y + border_width;
+        case CHILD_PROP_MIN_FRACTION:
+            g_value_set_float (value, splitter->priv->info[pos].min_fraction);
+            break;
 
+        case CHILD_PROP_MAX_FRACTION:
+            g_value_set_float (value, splitter->priv->info[pos].max_fraction);
+            break;
 
-            gtk_widget_size_allocate (splitter->priv->child1, &child1_allocation);
-            splitter->priv->child1_size = child1_allocation.width;
-            if (splitter->priv->size_mode != DDB_SPLITTER_SIZE_MODE_PROP) {
-                splitter->priv->proportion = CLAMP ((float)child1_allocation.width/(con_width - handle_size), 0.0f, 1.0f);
-            }
-            splitter->priv->handle_pos.x = allocation->x + splitter->priv->child1_size + border_width;
-            splitter->priv->handle_pos.y = allocation->y + border_width;
-            splitter->priv->handle_pos.width = handle_size;
-            splitter->priv->handle_pos.height = MAX (1, allocation->height - 2 * border_width);
-
-        }
-        if (child2_visible) {
-            // use full height in horitzontal splitter
-            child2_allocation.height = MAX (1, con_height);
-            gint width = 0;
-            if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_LOCK_C2) {
-                // child 2 locked, use saved size
-                width = splitter->priv->child2_size;
-            }
-            else {
-                if (num_visible_children == 1) {
-                    // only one child, use full width
-                    width = con_width;
-                }
-                else if (child1_visible && splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_LOCK_C1) {
-                    // two children and first one is locked, use all space left
-                    width = con_width - splitter->priv->child1_size - handle_size;
-                }
-                else {
-                    // two children visible and proportional scaling is active
-                    width = con_width - child1_allocation.width - handle_size;
-                }
+        case CHILD_PROP_SHRINK:
+            g_value_set_boolean (value, splitter->priv->info[pos].shrink);
+            break;
+
+        default:
+            GTK_CONTAINER_WARN_INVALID_CHILD_PROPERTY_ID (container, prop_id, pspec);
+            break;
+    }
+}
+
+static void
+ddb_splitter_set_child_property (GtkContainer *container,
+                                 GtkWidget *child,
+                                 guint prop_id,
+                                 const GValue *value,
+                                 GParamSpec *pspec)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (container);
+    gint pos = ddb_splitter_child_pos (splitter, child);
+    g_return_if_fail (pos >= 0);
+
+    DdbSplitterChildInfo *info = &splitter->priv->info[pos];
+
+    switch (prop_id)
+    {
+        case CHILD_PROP_DEFER_ALLOCATION:
+            info->defer_allocation = g_value_get_boolean (value);
+            ddb_splitter_clip_update (splitter, pos);
+            if (!info->defer_allocation && info->deferred) {
+                /* hand out the size it has been waiting for */
+                splitter->priv->flush_deferred = TRUE;
+                ddb_splitter_relayout (splitter);
+                splitter->priv->flush_deferred = FALSE;
             }
-            child2_allocation.width = MAX (1, width);
-            child2_allocation.x = child1_allocation.x + child1_allocation.width + handle_size;
-            child2_allocation.y = allocation->y + border_width;
+            break;
+
+        case CHILD_PROP_MIN_SIZE:
+            info->min_size = g_value_get_int (value);
+            ddb_splitter_relayout (splitter);
+            break;
+
+        case CHILD_PROP_MAX_SIZE:
+            info->max_size = g_value_get_int (value);
+            ddb_splitter_relayout (splitter);
+            break;
+
+        case CHILD_PROP_MIN_FRACTION:
+            info->min_fraction = g_value_get_float (value);
+            ddb_splitter_relayout (splitter);
+            break;
+
+        case CHILD_PROP_MAX_FRACTION:
+            info->max_fraction = g_value_get_float (value);
+            ddb_splitter_relayout (splitter);
+            break;
+
+        case CHILD_PROP_SHRINK:
+            info->shrink = g_value_get_boolean (value);
+            ddb_splitter_relayout (splitter);
+            break;
+
+        default:
+            GTK_CONTAINER_WARN_INVALID_CHILD_PROPERTY_ID (container, prop_id, pspec);
+            break;
+    }
+}
+
+static gboolean
+ddb_splitter_deferred_timeout (gpointer user_data)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (user_data);
+
+    splitter->priv->defer_id = 0;
+    splitter->priv->flush_deferred = TRUE;
+    ddb_splitter_relayout (splitter);
+    splitter->priv->flush_deferred = FALSE;
+
+    return FALSE;
+}
+
+static void
+ddb_splitter_schedule_deferred (DdbSplitter *splitter, gint64 sized_time, gint64 now)
+{
+    DdbSplitterPrivate *priv = splitter->priv;
 
-            gtk_widget_size_allocate (splitter->priv->child2, &child2_allocation);
-            splitter->priv->child2_size = child2_allocation.width;
+    if (priv->defer_interval == 0) {
+        /* wait until the size stops changing */
+        if (priv->defer_id) {
+            g_source_remove (priv->defer_id);
         }
+        priv->defer_id = g_timeout_add (DDB_SPLITTER_SETTLE_DELAY, ddb_splitter_deferred_timeout, splitter);
     }
-    else {
-        // splitter->priv->orientation == GTK_ORIENTATION_VERTICAL
+    else if (!priv->defer_id) {
+        gint64 remaining = priv->defer_interval - (now - sized_time) / 1000;
+        priv->defer_id = g_timeout_add (MAX (0, remaining), ddb_splitter_deferred_timeout, splitter);
+    }
+}
 
-        handle_size = num_visible_children > 1 ? splitter->priv->handle_size : 0;
-        if (child1_visible) {
-            // use full width in vertical splitter
-            child1_allocation.width = MAX (1, con_width);
+/* Whether a splitter between @splitter and the closest enclosing
+ * #GtkViewport has #DdbSplitter:virtualize set */
+static gboolean
+ddb_splitter_virtual_inherited (DdbSplitter *splitter)
+{
+    for (GtkWidget *ancestor = gtk_widget_get_parent (GTK_WIDGET (splitter));
+            ancestor && !GTK_IS_VIEWPORT (ancestor);
+            ancestor = gtk_widget_get_parent (ancestor)) {
+        if (DDB_IS_SPLITTER (ancestor) && DDB_SPLITTER (ancestor)->priv->virtualize) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
 
-            gint height = 0;
-            if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_LOCK_C1) {
-                // child 1 locked, use saved size
-                height = splitter->priv->child1_size;
-            }
-            else {
-                if (num_visible_children == 1) {
-                    // only one child, use full height
-                    height = con_height;
-                }
-                else if (child2_visible && splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_LOCK_C2) {
-                    // two children and second one is locked, use all space left
-                    height = con_height - splitter->priv->child2_size - handle_size;
+/* The closest enclosing #GtkViewport */
+static GtkWidget *
+ddb_splitter_virtual_viewport (DdbSplitter *splitter)
+{
+    for (GtkWidget *ancestor = gtk_widget_get_parent (GTK_WIDGET (splitter));
+            ancestor;
+            ancestor = gtk_widget_get_parent (ancestor)) {
+        if (GTK_IS_VIEWPORT (ancestor)) {
+            return ancestor;
+        }
+    }
+    return NULL;
+}
 
-                }
-                else {
-                    // two children visible and proportional scaling is active
-                    height = (con_height - handle_size) * splitter->priv->proportion;
-                }
+/* Follows the scrolling of @hadjustment and @vadjustment, or stops
+ * following if they are %NULL */
+static void
+ddb_splitter_virtual_track (DdbSplitter *splitter, GtkAdjustment *hadjustment, GtkAdjustment *vadjustment)
+{
+    DdbSplitterPrivate *priv = splitter->priv;
+    GtkAdjustment *adjustments[2] = { hadjustment, vadjustment };
+
+    for (guint i = 0; i < 2; i++) {
+        if (adjustments[i] == priv->virtual_adjustments[i]) {
+            continue;
+        }
+        if (priv->virtual_adjustments[i]) {
+            g_signal_handler_disconnect (priv->virtual_adjustments[i], priv->virtual_handlers[i]);
+            g_object_unref (priv->virtual_adjustments[i]);
+        }
+        priv->virtual_adjustments[i] = adjustments[i];
+        if (adjustments[i]) {
+            g_object_ref (adjustments[i]);
+            priv->virtual_handlers[i] = g_signal_connect (adjustments[i], "value-changed",
+                    G_CALLBACK (ddb_splitter_virtual_scrolled), splitter);
+        }
+    }
+}
+
+/* The view of @splitter in the coordinates of its child in slot @pos,
+ * which are those of the splitter unless the child is in a clip window */
+static void
+ddb_splitter_virtual_child_view (DdbSplitter *splitter, guint pos, GdkRectangle *view)
+{
+    DdbSplitterChildInfo *info = &splitter->priv->info[pos];
+
+    *view = splitter->priv->virtual_view;
+    if (info->clip) {
+        view->x -= info->allocation.x;
+        view->y -= info->allocation.y;
+    }
+}
+
+/* Works out which part of @splitter is in view of its viewport. A nested
+ * splitter takes the view of the parent splitter; only the topmost one
+ * asks the viewport. */
+static void
+ddb_splitter_virtual_update (DdbSplitter *splitter)
+{
+    DdbSplitterPrivate *priv = splitter->priv;
+    GtkWidget *parent = gtk_widget_get_parent (GTK_WIDGET (splitter));
+
+    if (priv->virtual_ancestor && DDB_IS_SPLITTER (parent)) {
+        ddb_splitter_virtual_track (splitter, NULL, NULL);
+        priv->virtual_active = DDB_SPLITTER (parent)->priv->virtual_active;
+        ddb_splitter_virtual_child_view (DDB_SPLITTER (parent),
+                ddb_splitter_child_pos (DDB_SPLITTER (parent), GTK_WIDGET (splitter)), &priv->virtual_view);
+        return;
+    }
+
+    GtkWidget *viewport = ddb_splitter_virtual_viewport (splitter);
+    GtkAdjustment *hadjustment = NULL;
+    GtkAdjustment *vadjustment = NULL;
+
+    if (viewport) {
+#if GTK_CHECK_VERSION(3,0,0)
+        hadjustment = gtk_scrollable_get_hadjustment (GTK_SCROLLABLE (viewport));
+        vadjustment = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (viewport));
+#else
+        hadjustment = gtk_viewport_get_hadjustment (GTK_VIEWPORT (viewport));
+        vadjustment = gtk_viewport_get_vadjustment (GTK_VIEWPORT (viewport));
+#endif
+    }
+    ddb_splitter_virtual_track (splitter, hadjustment, vadjustment);
+
+    priv->virtual_active = FALSE;
+    if (!hadjustment || !vadjustment
+            || gtk_adjustment_get_page_size (hadjustment) <= 0
+            || gtk_adjustment_get_page_size (vadjustment) <= 0) {
+        return;
+    }
+
+    GtkWidget *content = gtk_bin_get_child (GTK_BIN (viewport));
+    GtkAllocation allocation;
+    gint x, y;
+    if (!content || !gtk_widget_translate_coordinates (GTK_WIDGET (splitter), content, 0, 0, &x, &y)) {
+        return;
+    }
+    gtk_widget_get_allocation (GTK_WIDGET (splitter), &allocation);
+
+    priv->virtual_view.x = (gint)gtk_adjustment_get_value (hadjustment) - x + allocation.x;
+    priv->virtual_view.y = (gint)gtk_adjustment_get_value (vadjustment) - y + allocation.y;
+    priv->virtual_view.width = (gint)ceil (gtk_adjustment_get_page_size (hadjustment));
+    priv->virtual_view.height = (gint)ceil (gtk_adjustment_get_page_size (vadjustment));
+    priv->virtual_active = TRUE;
+}
+
+/* Whether @allocation is at least partly in view */
+static gboolean
+ddb_splitter_virtual_in_view (DdbSplitter *splitter, const GtkAllocation *allocation)
+{
+    GdkRectangle visible;
+
+    if (!splitter->priv->virtual_active) {
+        return TRUE;
+    }
+    return gdk_rectangle_intersect (allocation, &splitter->priv->virtual_view, &visible);
+}
+
+#if !GTK_CHECK_VERSION(3,16,0)
+/* Whether a splitter above @splitter is moving its child, and with it
+ * everything below including @splitter, by copying */
+static gboolean
+ddb_splitter_ancestor_translating (DdbSplitter *splitter)
+{
+    for (GtkWidget *ancestor = gtk_widget_get_parent (GTK_WIDGET (splitter));
+            ancestor;
+            ancestor = gtk_widget_get_parent (ancestor)) {
+        if (DDB_IS_SPLITTER (ancestor) && DDB_SPLITTER (ancestor)->priv->translating) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+#endif
+
+/* Gives @child, which keeps its size, the position of @allocation. If
+ * possible, what it shows is copied over from @old_allocation, so only
+ * the strip it uncovers gets repainted */
+static void
+ddb_splitter_translate_child (DdbSplitter *splitter, GtkWidget *child, const GtkAllocation *old_allocation, GtkAllocation *allocation)
+{
+#if GTK_CHECK_VERSION(3,16,0)
+    /* windows don't keep their contents since GTK 3.16, moving a region
+     * only invalidates it, so there's nothing to copy */
+    gtk_widget_size_allocate (child, allocation);
+#else
+    if (!splitter->priv->copy_on_move || gtk_widget_get_has_window (child) || !gtk_widget_is_drawable (child)
+            || ddb_splitter_ancestor_translating (splitter)) {
+        gtk_widget_size_allocate (child, allocation);
+        return;
+    }
+
+    GdkWindow *window = gtk_widget_get_window (child);
+    gint dx = allocation->x - old_allocation->x;
+    gint dy = allocation->y - old_allocation->y;
+
+#if GTK_CHECK_VERSION(3,0,0)
+    cairo_region_t *damage = gdk_window_get_update_area (window);
+    splitter->priv->translating = TRUE;
+    gtk_widget_size_allocate (child, allocation);
+    splitter->priv->translating = FALSE;
+
+    /* the copy takes care of what the allocation invalidated at the old
+     * and the new place */
+    cairo_region_t *invalid = gdk_window_get_update_area (window);
+    if (invalid) {
+        cairo_region_t *moved = cairo_region_create_rectangle (old_allocation);
+        cairo_region_union_rectangle (moved, allocation);
+        cairo_region_subtract (invalid, moved);
+        gdk_window_invalidate_region (window, invalid, TRUE);
+        cairo_region_destroy (moved);
+        cairo_region_destroy (invalid);
+    }
+
+    cairo_region_t *region = cairo_region_create_rectangle (old_allocation);
+    gdk_window_move_region (window, region, dx, dy);
+    cairo_region_destroy (region);
+
+    if (damage) {
+        /* pending damage of the child moves along with it, the rest stays
+         * where it was, except for what the child now covers */
+        cairo_region_t *carried = cairo_region_copy (damage);
+        cairo_region_intersect_rectangle (carried, old_allocation);
+        cairo_region_translate (carried, dx, dy);
+        region = cairo_region_create_rectangle (allocation);
+        cairo_region_subtract (damage, region);
+        cairo_region_union (damage, carried);
+        gdk_window_invalidate_region (window, damage, TRUE);
+        cairo_region_destroy (region);
+        cairo_region_destroy (carried);
+        cairo_region_destroy (damage);
+    }
+#else
+    GdkRegion *damage = gdk_window_get_update_area (window);
+    splitter->priv->translating = TRUE;
+    gtk_widget_size_allocate (child, allocation);
+    splitter->priv->translating = FALSE;
+
+    /* the copy takes care of what the allocation invalidated at the old
+     * and the new place */
+    GdkRegion *invalid = gdk_window_get_update_area (window);
+    if (invalid) {
+        GdkRegion *moved = gdk_region_rectangle (old_allocation);
+        gdk_region_union_with_rect (moved, allocation);
+        gdk_region_subtract (invalid, moved);
+        gdk_window_invalidate_region (window, invalid, TRUE);
+        gdk_region_destroy (moved);
+        gdk_region_destroy (invalid);
+    }
+
+    GdkRegion *region = gdk_region_rectangle (old_allocation);
+    gdk_window_move_region (window, region, dx, dy);
+    gdk_region_destroy (region);
+
+    if (damage) {
+        /* pending damage of the child moves along with it, the rest stays
+         * where it was, except for what the child now covers */
+        GdkRegion *carried = gdk_region_copy (damage);
+        region = gdk_region_rectangle (old_allocation);
+        gdk_region_intersect (carried, region);
+        gdk_region_offset (carried, dx, dy);
+        gdk_region_destroy (region);
+        region = gdk_region_rectangle (allocation);
+        gdk_region_subtract (damage, region);
+        gdk_region_union (damage, carried);
+        gdk_window_invalidate_region (window, damage, TRUE);
+        gdk_region_destroy (region);
+        gdk_region_destroy (carried);
+        gdk_region_destroy (damage);
+    }
+#endif
+    splitter->priv->stats.child_moves_copied++;
+#endif
+}
+
+/* Shows the clip window of a child along with the child */
+static void
+ddb_splitter_clip_child_map (GtkWidget *child, gpointer user_data)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (user_data);
+    gint pos = ddb_splitter_child_pos (splitter, child);
+
+    if (pos >= 0 && splitter->priv->info[pos].clip) {
+        gdk_window_show (splitter->priv->info[pos].clip);
+    }
+}
+
+static void
+ddb_splitter_clip_child_unmap (GtkWidget *child, gpointer user_data)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (user_data);
+    gint pos = ddb_splitter_child_pos (splitter, child);
+
+    if (pos >= 0 && splitter->priv->info[pos].clip) {
+        gdk_window_hide (splitter->priv->info[pos].clip);
+    }
+}
+
+typedef struct
+{
+    GdkWindow *from;
+    GdkWindow *to;
+} DdbSplitterClipMove;
+
+/* Points @widget and the widgets without a window below it that drew
+ * into the old window at the new one */
+static void
+ddb_splitter_clip_fixup (GtkWidget *widget, gpointer user_data)
+{
+    DdbSplitterClipMove *move = user_data;
+
+    if (gtk_widget_get_has_window (widget) || gtk_widget_get_window (widget) != move->from) {
+        return;
+    }
+    g_object_ref (move->to);
+    gtk_widget_set_window (widget, move->to);
+    g_object_unref (move->from);
+    if (GTK_IS_CONTAINER (widget)) {
+        gtk_container_forall (GTK_CONTAINER (widget), ddb_splitter_clip_fixup, move);
+    }
+}
+
+/* Moves the windows of the realized @child from @from into @to, the way
+ * gtk_widget_reparent() does when the parent changes */
+static void
+ddb_splitter_clip_move_windows (GtkWidget *child, GdkWindow *from, GdkWindow *to)
+{
+    if (gtk_widget_get_has_window (child)) {
+        gdk_window_reparent (gtk_widget_get_window (child), to, 0, 0);
+        return;
+    }
+
+    GList *windows = gdk_window_get_children (from);
+    for (GList *l = windows; l; l = l->next) {
+        gpointer owner = NULL;
+        gdk_window_get_user_data (l->data, &owner);
+        if (GTK_IS_WIDGET (owner) && (owner == child || gtk_widget_is_ancestor (owner, child))) {
+            gdk_window_reparent (l->data, to, 0, 0);
+        }
+    }
+    g_list_free (windows);
+
+    DdbSplitterClipMove move = { from, to };
+    ddb_splitter_clip_fixup (child, &move);
+}
+
+/* Takes the child in slot @pos out of its clip window, if it has one,
+ * and destroys the window. The child needs a new allocation after. */
+static void
+ddb_splitter_clip_remove (DdbSplitter *splitter, guint pos)
+{
+    DdbSplitterPrivate *priv = splitter->priv;
+    GtkWidget *child = pos == 0 ? priv->child1 : priv->child2;
+    DdbSplitterChildInfo *info = &priv->info[pos];
+
+    if (!info->clip) {
+        return;
+    }
+
+    if (child) {
+        g_signal_handler_disconnect (child, info->clip_map_id);
+        g_signal_handler_disconnect (child, info->clip_unmap_id);
+        if (gtk_widget_get_realized (child)) {
+            ddb_splitter_clip_move_windows (child, info->clip, gtk_widget_get_window (GTK_WIDGET (splitter)));
+        }
+        gtk_widget_set_parent_window (child, NULL);
+    }
+    info->clip_map_id = 0;
+    info->clip_unmap_id = 0;
+
+#if GTK_CHECK_VERSION(3,8,0)
+    gtk_widget_unregister_window (GTK_WIDGET (splitter), info->clip);
+#else
+    gdk_window_set_user_data (info->clip, NULL);
+#endif
+    gdk_window_destroy (info->clip);
+    info->clip = NULL;
+    info->allocated = FALSE;
+    info->deferred = FALSE;
+}
+
+/* Puts the child in slot @pos into a clip window while it has
+ * defer-allocation set and the splitter is realized, and takes it out
+ * again otherwise. A realized child keeps its windows. */
+static void
+ddb_splitter_clip_update (DdbSplitter *splitter, guint pos)
+{
+    DdbSplitterPrivate *priv = splitter->priv;
+    GtkWidget *widget = GTK_WIDGET (splitter);
+    GtkWidget *child = pos == 0 ? priv->child1 : priv->child2;
+    DdbSplitterChildInfo *info = &priv->info[pos];
+    GdkWindow *window = gtk_widget_get_window (widget);
+
+    if (!child || !info->defer_allocation || !gtk_widget_get_realized (widget) || !window) {
+        if (info->clip) {
+            GtkAllocation slot = info->allocation;
+            gboolean allocated = info->allocated;
+            ddb_splitter_clip_remove (splitter, pos);
+            if (child && allocated && gtk_widget_get_realized (child)) {
+                /* back in the coordinates of the splitter, at full size */
+                gtk_widget_size_allocate (child, &slot);
+                info->allocated = TRUE;
+                info->sized_time = g_get_monotonic_time ();
             }
-            child1_allocation.height = MAX (1, height);
-            child1_allocation.x =allocation->x + border_width;
-            child1_allocation.y = allocation->y + border_width;
-
-            gtk_widget_size_allocate (splitter->priv->child1, &child1_allocation);
-            splitter->priv->child1_size = child1_allocation.height;
-            if (splitter->priv->size_mode != DDB_SPLITTER_SIZE_MODE_PROP) {
-                splitter->priv->proportion = CLAMP ((float)child1_allocation.height/(con_height - handle_size), 0.0f, 1.0f);
+            else if (child && allocated) {
+                gtk_widget_queue_resize (widget);
             }
-            splitter->priv->handle_pos.x = allocation->x + border_width;
-            splitter->priv->handle_pos.y = allocation->y + splitter->priv->child1_size + border_width;
-            splitter->priv->handle_pos.width = MAX (1, (gint) allocation->width - 2 * border_width);
-            splitter->priv->handle_pos.height = handle_size;
+        }
+        return;
+    }
+    if (info->clip) {
+        return;
+    }
+
+    GdkWindowAttr attributes;
+    attributes.window_type = GDK_WINDOW_CHILD;
+    attributes.wclass = GDK_INPUT_OUTPUT;
+    attributes.x = info->allocated ? info->allocation.x : 0;
+    attributes.y = info->allocated ? info->allocation.y : 0;
+    attributes.width = info->allocated ? MAX (1, info->allocation.width) : 1;
+    attributes.height = info->allocated ? MAX (1, info->allocation.height) : 1;
+    attributes.visual = gtk_widget_get_visual (widget);
+    attributes.event_mask = gtk_widget_get_events (widget) | GDK_EXPOSURE_MASK;
+#if GTK_CHECK_VERSION(3,0,0)
+    info->clip = gdk_window_new (window, &attributes, GDK_WA_X | GDK_WA_Y | GDK_WA_VISUAL);
+#else
+    attributes.colormap = gtk_widget_get_colormap (widget);
+    info->clip = gdk_window_new (window, &attributes, GDK_WA_X | GDK_WA_Y | GDK_WA_VISUAL | GDK_WA_COLORMAP);
+    gtk_style_set_background (gtk_widget_get_style (widget), info->clip, GTK_STATE_NORMAL);
+#endif
+#if GTK_CHECK_VERSION(3,8,0)
+    gtk_widget_register_window (widget, info->clip);
+#else
+    gdk_window_set_user_data (info->clip, splitter);
+#endif
 
+    gtk_widget_set_parent_window (child, info->clip);
+    info->clip_map_id = g_signal_connect (child, "map", G_CALLBACK (ddb_splitter_clip_child_map), splitter);
+    info->clip_unmap_id = g_signal_connect (child, "unmap", G_CALLBACK (ddb_splitter_clip_child_unmap), splitter);
+    info->clip_width = info->allocation.width;
+    info->clip_height = info->allocation.height;
+
+    if (gtk_widget_get_realized (child)) {
+        ddb_splitter_clip_move_windows (child, window, info->clip);
+        if (info->allocated) {
+            /* its allocation is relative to the clip window now */
+            GtkAllocation inner = { 0, 0, info->clip_width, info->clip_height };
+            gtk_widget_size_allocate (child, &inner);
         }
-        if (child2_visible) {
-            // use full width in vertical splitter
-            child2_allocation.width = MAX (1, con_width);
+    }
+    else if (info->allocated) {
+        /* a fresh allocation once it is laid out in the clip window */
+        info->allocated = FALSE;
+        gtk_widget_queue_resize (widget);
+    }
+    if (gtk_widget_get_mapped (child)) {
+        gdk_window_show (info->clip);
+    }
+}
 
-            gint height = 0;
-            if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_LOCK_C2) {
-                // child 2 locked, use saved size
-                height = splitter->priv->child2_size;
-            }
-            else {
-                if (num_visible_children == 1) {
-                    // only one child, use full height
-                    height = con_height;
-                }
-                else if (child1_visible && splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_LOCK_C1) {
-                    // two children and first one is locked, use all space left
-                    height = con_height - splitter->priv->child1_size - handle_size;
-                }
-                else {
-                    // two children visible and proportional scaling is active
-                    height = con_height - child1_allocation.height - handle_size;
-                }
+/* Points the children of splitters at or below @widget back at their
+ * clip windows, after gtk_widget_reparent() pointed every widget without
+ * a window of its own at the new parent window */
+static void
+ddb_splitter_clip_repair (GtkWidget *widget, gpointer user_data)
+{
+    if (DDB_IS_SPLITTER (widget)) {
+        DdbSplitterPrivate *priv = DDB_SPLITTER (widget)->priv;
+        GtkWidget *children[2] = { priv->child1, priv->child2 };
+        for (guint i = 0; i < 2; i++) {
+            if (children[i] && priv->info[i].clip && gtk_widget_get_realized (children[i])
+                    && !gtk_widget_get_has_window (children[i])
+                    && gtk_widget_get_window (children[i]) != priv->info[i].clip) {
+                DdbSplitterClipMove move = { gtk_widget_get_window (children[i]), priv->info[i].clip };
+                ddb_splitter_clip_fixup (children[i], &move);
             }
-            child2_allocation.height = MAX (1, height);
-            child2_allocation.x = allocation->x + border_width;
-            child2_allocation.y = child1_allocation.y + child1_allocation.height + handle_size;
+        }
+    }
+    if (GTK_IS_CONTAINER (widget)) {
+        gtk_container_forall (GTK_CONTAINER (widget), ddb_splitter_clip_repair, NULL);
+    }
+}
+
+/* Hands @allocation to the child in slot @pos, unless its size change
+ * is deferred or the child is out of view */
+static void
+ddb_splitter_allocate_child (DdbSplitter *splitter, guint pos, GtkAllocation *allocation)
+{
+    DdbSplitterPrivate *priv = splitter->priv;
+    GtkWidget *child = pos == 0 ? priv->child1 : priv->child2;
+    DdbSplitterChildInfo *info = &priv->info[pos];
+    gint width = info->clip ? info->clip_width : info->allocation.width;
+    gint height = info->clip ? info->clip_height : info->allocation.height;
+    gboolean resized = !info->allocated
+        || allocation->width != width
+        || allocation->height != height;
+    gint64 now = g_get_monotonic_time ();
+
+    if (G_UNLIKELY (priv->virtual_active) && !ddb_splitter_virtual_in_view (splitter, allocation)) {
+        /* unmap it until it scrolls into view */
+        if (gtk_widget_get_child_visible (child)) {
+            gtk_widget_set_child_visible (child, FALSE);
+        }
+        info->virtualized = TRUE;
+        info->virtual_allocation = *allocation;
+        priv->stats.child_allocations_skipped++;
+        return;
+    }
+    if (G_UNLIKELY (info->virtualized)) {
+        info->virtualized = FALSE;
+        gtk_widget_set_child_visible (child, TRUE);
+    }
+
+    if (info->clip) {
+        /* the child moves along with its clip window */
+        gdk_window_move_resize (info->clip, allocation->x, allocation->y,
+                MAX (1, allocation->width), MAX (1, allocation->height));
+    }
+
+    if (resized && info->defer_allocation && info->allocated && !priv->flush_deferred
+            && (priv->defer_interval == 0 || now - info->sized_time < priv->defer_interval * (gint64)1000)) {
+        /* the child keeps its old size until the timer hands out the new
+         * one, cut off or padded by its clip window. Without one the
+         * splitter isn't realized and nothing is shown anyway. */
+        priv->stats.child_allocations_skipped++;
+        if (info->clip) {
+            info->allocation = *allocation;
+        }
+        info->deferred = TRUE;
+        ddb_splitter_schedule_deferred (splitter, info->sized_time, now);
+        return;
+    }
+
+    if (info->clip && !resized) {
+        priv->stats.child_allocations_skipped++;
+        info->allocation = *allocation;
+        info->deferred = FALSE;
+        return;
+    }
+
+    priv->stats.child_allocations++;
+    DDB_SPLITTER_TRACE_BEGIN (splitter, "allocate_child");
+    if (info->clip) {
+        GtkAllocation inner = { 0, 0, allocation->width, allocation->height };
+        gtk_widget_size_allocate (child, &inner);
+        info->clip_width = allocation->width;
+        info->clip_height = allocation->height;
+    }
+    else if (!resized && (allocation->x != info->allocation.x || allocation->y != info->allocation.y)) {
+        ddb_splitter_translate_child (splitter, child, &info->allocation, allocation);
+    }
+    else {
+        gtk_widget_size_allocate (child, allocation);
+    }
+    DDB_SPLITTER_TRACE_END (splitter, "allocate_child");
+    gint64 elapsed = g_get_monotonic_time () - now;
+    priv->stats.child_allocate_time += elapsed;
+    if (G_UNLIKELY (priv->heatmap)) {
+        ddb_splitter_heat_record_allocation (splitter, pos, elapsed);
+    }
+    info->allocation = *allocation;
+    info->allocated = TRUE;
+    info->deferred = FALSE;
+    if (resized) {
+        info->sized_time = now;
+    }
+}
+
+/* Brings the children scrolled into view in and takes the ones scrolled
+ * out of view out, without touching the others. Nested splitters that
+ * stay in view get the new view and do the same; the ones out of view
+ * are skipped with everything below them. */
+static void
+ddb_splitter_virtual_scroll (DdbSplitter *splitter)
+{
+    DdbSplitterPrivate *priv = splitter->priv;
+    GtkWidget *children[2] = { priv->child1, priv->child2 };
+
+    for (guint i = 0; i < 2; i++) {
+        DdbSplitterChildInfo *info = &priv->info[i];
+        if (!children[i] || !gtk_widget_get_visible (children[i]) || (!info->allocated && !info->virtualized)
+                || (priv->size_mode == DDB_SPLITTER_SIZE_MODE_STACK && i != priv->active_child)) {
+            continue;
+        }
 
-            gtk_widget_size_allocate (splitter->priv->child2, &child2_allocation);
-            splitter->priv->child2_size = child2_allocation.height;
+        GtkAllocation allocation = info->virtualized ? info->virtual_allocation : info->allocation;
+        if (ddb_splitter_virtual_in_view (splitter, &allocation) == info->virtualized) {
+            /* a child coming into view is allocated from scratch */
+            ddb_splitter_allocate_child (splitter, i, &allocation);
         }
+        else if (!info->virtualized && DDB_IS_SPLITTER (children[i])) {
+            DdbSplitter *nested = DDB_SPLITTER (children[i]);
+            nested->priv->virtual_active = priv->virtual_active;
+            ddb_splitter_virtual_child_view (splitter, i, &nested->priv->virtual_view);
+            ddb_splitter_virtual_scroll (nested);
+        }
+    }
+}
+
+static void
+ddb_splitter_virtual_scrolled (GtkAdjustment *adjustment, gpointer user_data)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (user_data);
+
+    /* a hidden splitter gets a fresh allocation once it is shown again,
+     * the one it has now may be out of date */
+    if (!gtk_widget_get_mapped (GTK_WIDGET (splitter))) {
+        return;
     }
 
-    if (!child1_visible && !child2_visible) {
-        GtkAllocation child_allocation;
+    ddb_splitter_virtual_update (splitter);
+    ddb_splitter_virtual_scroll (splitter);
+}
+
+static void
+ddb_splitter_virtual_refresh_widget (GtkWidget *widget, gpointer user_data);
+
+/* Works out again whether @splitter and the splitters below it are
+ * virtualized, and reallocates them, after #DdbSplitter:virtualize was
+ * switched on or off above them or they were moved */
+static void
+ddb_splitter_virtual_refresh (DdbSplitter *splitter)
+{
+    DdbSplitterPrivate *priv = splitter->priv;
+
+    priv->virtual_ancestor = ddb_splitter_virtual_inherited (splitter);
+    if (!priv->virtualize && !priv->virtual_ancestor) {
+        ddb_splitter_virtual_track (splitter, NULL, NULL);
+        priv->virtual_active = FALSE;
+    }
+    ddb_splitter_relayout (splitter);
+    gtk_container_forall (GTK_CONTAINER (splitter), ddb_splitter_virtual_refresh_widget, NULL);
+}
+
+static void
+ddb_splitter_virtual_refresh_widget (GtkWidget *widget, gpointer user_data)
+{
+    if (DDB_IS_SPLITTER (widget)) {
+        ddb_splitter_virtual_refresh (DDB_SPLITTER (widget));
+    }
+    else if (GTK_IS_CONTAINER (widget)) {
+        gtk_container_forall (GTK_CONTAINER (widget), ddb_splitter_virtual_refresh_widget, NULL);
+    }
+}
+
+/* Follows a change of the ancestors of @splitter */
+static void
+ddb_splitter_virtual_reparented (DdbSplitter *splitter)
+{
+    if (ddb_splitter_virtual_inherited (splitter) != splitter->priv->virtual_ancestor) {
+        ddb_splitter_virtual_refresh (splitter);
+    }
+}
+
+static void
+ddb_splitter_parent_set (GtkWidget *widget, GtkWidget *previous_parent)
+{
+    ddb_splitter_virtual_reparented (DDB_SPLITTER (widget));
+}
+
+/* also covers splitters nested in a subtree that was moved */
+static void
+ddb_splitter_hierarchy_changed (GtkWidget *widget, GtkWidget *previous_toplevel)
+{
+    ddb_splitter_virtual_reparented (DDB_SPLITTER (widget));
+}
+
+/* Identifies the frame being laid out */
+static gint64
+ddb_splitter_frame_id (GtkWidget *widget)
+{
+#if GTK_CHECK_VERSION(3,8,0)
+    GdkFrameClock *frame_clock = gtk_widget_get_frame_clock (widget);
+    if (frame_clock) {
+        return gdk_frame_clock_get_frame_counter (frame_clock);
+    }
+#endif
+    return g_get_monotonic_time () / DDB_SPLITTER_FRAME_INTERVAL;
+}
+
+static void
+ddb_splitter_thrash_report (DdbSplitter *splitter, const gchar *problem)
+{
+    DdbSplitterPrivate *priv = splitter->priv;
+    GtkWidget *child = NULL;
+
+    if (priv->thrash_child >= 0) {
+        child = priv->thrash_child == 0 ? priv->child1 : priv->child2;
+    }
+    if (child) {
+        g_warning ("DdbSplitter %p: %s; child %s %p last changed its size request from %dx%d to %dx%d",
+                (gpointer)splitter, problem, G_OBJECT_TYPE_NAME (child), (gpointer)child,
+                priv->thrash_req_from.width, priv->thrash_req_from.height,
+                priv->thrash_req_to.width, priv->thrash_req_to.height);
+    }
+    else {
+        g_warning ("DdbSplitter %p: %s", (gpointer)splitter, problem);
+    }
+    priv->stats.thrash_detections++;
+    if (thrash_break) {
+        G_BREAKPOINT ();
+    }
+}
+
+/* Counts the allocations of the current frame and remembers which child
+ * changed its size request */
+static void
+ddb_splitter_thrash_begin (DdbSplitter *splitter)
+{
+    DdbSplitterPrivate *priv = splitter->priv;
+    GtkWidget *children[2] = { priv->child1, priv->child2 };
+
+    for (guint i = 0; i < 2; i++) {
+        GtkRequisition req = { 0, 0 };
+        if (children[i] && gtk_widget_get_visible (children[i])) {
+#if GTK_CHECK_VERSION(3,0,0)
+            gtk_widget_get_preferred_size (children[i], &req, NULL);
+#else
+            gtk_widget_get_child_requisition (children[i], &req);
+#endif
+        }
+        if (priv->info[i].allocated
+                && (req.width != priv->info[i].requisition.width || req.height != priv->info[i].requisition.height)) {
+            priv->thrash_child = i;
+            priv->thrash_req_from = priv->info[i].requisition;
+            priv->thrash_req_to = req;
+        }
+        priv->info[i].requisition = req;
+    }
+
+    gint64 frame = ddb_splitter_frame_id (GTK_WIDGET (splitter));
+    if (frame != priv->thrash_frame) {
+        priv->thrash_frame = frame;
+        priv->thrash_allocations = 0;
+        priv->thrash_reported = FALSE;
+        /* values from earlier frames are normal relayouts, not flipping */
+        priv->thrash_history_len[0] = 0;
+        priv->thrash_history_len[1] = 0;
+    }
+    priv->thrash_allocations++;
+    if (priv->thrash_allocations > thrash_limit && !priv->thrash_reported) {
+        gchar *problem = g_strdup_printf ("allocated more than %u times in one frame", thrash_limit);
+        ddb_splitter_thrash_report (splitter, problem);
+        g_free (problem);
+        priv->thrash_reported = TRUE;
+    }
+}
+
+/* Records a layout value and reports it if it keeps alternating between
+ * two values within the current frame */
+static void
+ddb_splitter_thrash_record (DdbSplitter *splitter, guint kind, gfloat value)
+{
+    DdbSplitterPrivate *priv = splitter->priv;
+    gfloat *history = priv->thrash_history[kind];
+    guint len = priv->thrash_history_len[kind];
+
+    if (len > 0 && history[len - 1] == value) {
+        return;
+    }
+    if (len == 4) {
+        memmove (history, history + 1, 3 * sizeof (gfloat));
+        len--;
+    }
+    history[len++] = value;
+    priv->thrash_history_len[kind] = len;
+
+    if (len == 4 && history[0] == history[2] && history[1] == history[3]) {
+        gchar *problem = g_strdup_printf ("%s oscillates: %g, %g, %g, %g",
+                kind == 0 ? "proportion" : "locked size",
+                history[0], history[1], history[2], history[3]);
+        ddb_splitter_thrash_report (splitter, problem);
+        g_free (problem);
+        priv->thrash_history_len[kind] = 0;
+    }
+}
+
+static void
+ddb_splitter_thrash_end (DdbSplitter *splitter)
+{
+    DdbSplitterPrivate *priv = splitter->priv;
+
+    /* changes made by the user or an animation are expected */
+    if (priv->in_drag || priv->anim_id) {
+        priv->thrash_history_len[0] = 0;
+        priv->thrash_history_len[1] = 0;
+        return;
+    }
+    ddb_splitter_thrash_record (splitter, 0, priv->proportion);
+    if (priv->size_mode == DDB_SPLITTER_SIZE_MODE_LOCK_C1) {
+        ddb_splitter_thrash_record (splitter, 1, priv->child1_size);
+    }
+    else if (priv->size_mode == DDB_SPLITTER_SIZE_MODE_LOCK_C2) {
+        ddb_splitter_thrash_record (splitter, 1, priv->child2_size);
+    }
+}
+
+static gboolean
+ddb_splitter_unrealize_timeout (gpointer user_data)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (user_data);
+    GtkWidget *inactive = splitter->priv->active_child == 0 ? splitter->priv->child2 : splitter->priv->child1;
+
+    splitter->priv->unrealize_id = 0;
+    if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_STACK
+            && inactive && !gtk_widget_get_child_visible (inactive)) {
+        gtk_widget_unrealize (inactive);
+    }
+    return FALSE;
+}
+
+/* Hides the inactive child in the stack size mode, which is left alone
+ * otherwise, and shows the active one */
+static void
+ddb_splitter_update_stack (DdbSplitter *splitter)
+{
+    DdbSplitterPrivate *priv = splitter->priv;
+    guint active = priv->active_child;
+    GtkWidget *children[2] = { priv->child1, priv->child2 };
+
+    if (children[1 - active] && gtk_widget_get_child_visible (children[1 - active])) {
+        gtk_widget_set_child_visible (children[1 - active], FALSE);
+    }
+    if (children[active] && !gtk_widget_get_child_visible (children[active])) {
+        gtk_widget_set_child_visible (children[active], TRUE);
+    }
+
+    if (children[1 - active] && gtk_widget_get_realized (children[1 - active])
+            && priv->unrealize_timeout >= 0 && !priv->unrealize_id) {
+        priv->unrealize_id = g_timeout_add (priv->unrealize_timeout, ddb_splitter_unrealize_timeout, splitter);
+    }
+}
+
+static void
+ddb_splitter_rect_to_gdk (const DdbSplitterRect *rect, GdkRectangle *gdk_rect)
+{
+    gdk_rect->x = rect->x;
+    gdk_rect->y = rect->y;
+    gdk_rect->width = rect->width;
+    gdk_rect->height = rect->height;
+}
+
+/* The smallest size along the split the child in slot @pos may get */
+static gint
+ddb_splitter_child_min_size (DdbSplitter *splitter, guint pos)
+{
+    DdbSplitterChildInfo *info = &splitter->priv->info[pos];
+    gint min_size = info->min_size;
+
+    if (!info->shrink) {
+        gint request;
+#if GTK_CHECK_VERSION(3,0,0)
+        gint natural;
+        ddb_splitter_child_preferred_size (splitter, pos, splitter->priv->orientation, &request, &natural);
+#else
+        GtkRequisition requisition;
+        ddb_splitter_child_size_request (splitter, pos, &requisition);
+        request = splitter->priv->orientation == GTK_ORIENTATION_HORIZONTAL ? requisition.width : requisition.height;
+#endif
+        min_size = MAX (min_size, request);
+    }
+    return min_size;
+}
+
+/* Describes @splitter within @allocation to the layout core */
+static void
+ddb_splitter_layout_input (DdbSplitter *splitter, const GtkAllocation *allocation, DdbSplitterLayoutInput *input)
+{
+    DdbSplitterPrivate *priv = splitter->priv;
+    // TODO: consider border width
+    gint border_width = 0;
+
+    input->area.x = allocation->x + border_width;
+    input->area.y = allocation->y + border_width;
+    input->area.width = allocation->width - border_width * 2;
+    input->area.height = allocation->height - border_width * 2;
+    input->vertical = priv->orientation == GTK_ORIENTATION_VERTICAL;
+    input->mode = (DdbSplitterLayoutMode)priv->size_mode;
+    input->proportion = priv->proportion;
+    input->child1_size = priv->child1_size;
+    input->child2_size = priv->child2_size;
+    input->handle_size = priv->handle_size;
+    input->visible[0] = priv->child1 && gtk_widget_get_visible (priv->child1);
+    input->visible[1] = priv->child2 && gtk_widget_get_visible (priv->child2);
+    input->active_child = priv->active_child;
+
+    for (guint i = 0; i < 2; i++) {
+        input->min_size[i] = input->visible[i] ? ddb_splitter_child_min_size (splitter, i) : 0;
+        input->max_size[i] = priv->info[i].max_size;
+        input->min_fraction[i] = priv->info[i].min_fraction;
+        input->max_fraction[i] = priv->info[i].max_fraction;
+    }
+}
+
+/* Computes where the children and the handle of @splitter go within
+ * @allocation, without changing anything */
+static void
+ddb_splitter_compute_layout (DdbSplitter *splitter, const GtkAllocation *allocation, DdbSplitterLayout *layout)
+{
+    DdbSplitterLayoutInput input;
+
+    ddb_splitter_layout_input (splitter, allocation, &input);
+    ddb_splitter_layout_compute (&input, layout);
+}
+
+/* Takes over @layout, allocates the children and moves the handle
+ * accordingly */
+static void
+ddb_splitter_apply_layout (DdbSplitter *splitter, const DdbSplitterLayout *layout)
+{
+    GtkWidget *widget = GTK_WIDGET (splitter);
+    GtkAllocation allocation;
+    GdkRectangle old_handle_pos = splitter->priv->handle_pos;
+
+    gtk_widget_get_allocation (widget, &allocation);
+
+    if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_STACK) {
+        ddb_splitter_update_stack (splitter);
+    }
+
+    splitter->priv->child1_size = layout->child1_size;
+    splitter->priv->child2_size = layout->child2_size;
+    splitter->priv->proportion = layout->proportion;
+    ddb_splitter_rect_to_gdk (&layout->handle, &splitter->priv->handle_pos);
+
+    /* children moving right or down are placed from the last one on,
+     * so that copying one doesn't overwrite the other one before it
+     * is copied itself */
+    guint first = 0;
+    for (guint i = 0; i < 2; i++) {
+        DdbSplitterChildInfo *info = &splitter->priv->info[i];
+        if (layout->visible[i] && info->allocated
+                && (layout->child[i].x > info->allocation.x || layout->child[i].y > info->allocation.y)) {
+            first = 1;
+        }
+    }
+    for (guint n = 0; n < 2; n++) {
+        guint i = n ^ first;
+        if (layout->visible[i]) {
+            GtkAllocation child_allocation;
+            ddb_splitter_rect_to_gdk (&layout->child[i], &child_allocation);
+            ddb_splitter_allocate_child (splitter, i, &child_allocation);
+        }
+    }
+
+    if (!layout->visible[0] && !layout->visible[1] && splitter->priv->size_mode != DDB_SPLITTER_SIZE_MODE_STACK) {
+        if (splitter->priv->child1)
+            gtk_widget_set_child_visible (splitter->priv->child1, TRUE);
+        if (splitter->priv->child2)
+            gtk_widget_set_child_visible (splitter->priv->child2, TRUE);
+    }
+
+    if (gtk_widget_get_mapped (widget) &&
+            (old_handle_pos.x != splitter->priv->handle_pos.x ||
+             old_handle_pos.y != splitter->priv->handle_pos.y ||
+             old_handle_pos.width != splitter->priv->handle_pos.width ||
+             old_handle_pos.height != splitter->priv->handle_pos.height))
+    {
+        GdkWindow *window = gtk_widget_get_window (widget);
+        gdk_window_invalidate_rect (window, &old_handle_pos, FALSE);
+        gdk_window_invalidate_rect (window, &splitter->priv->handle_pos, FALSE);
+        if (G_UNLIKELY (splitter->priv->heatmap)) {
+            ddb_splitter_heat_flash_handle (splitter);
+        }
+    }
+
+    if (gtk_widget_get_realized (widget)) {
+        if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_STACK)
+            gdk_window_hide (splitter->priv->handle);
+        else if (gtk_widget_get_mapped (widget))
+            gdk_window_show (splitter->priv->handle);
+
+        if (splitter->priv->orientation == GTK_ORIENTATION_HORIZONTAL)
+        {
+            gdk_window_move_resize (splitter->priv->handle,
+                    splitter->priv->handle_pos.x,
+                    splitter->priv->handle_pos.y,
+                    layout->handle_size,
+                    splitter->priv->handle_pos.height);
+        }
+        else {
+            gdk_window_move_resize (splitter->priv->handle,
+                    splitter->priv->handle_pos.x,
+                    splitter->priv->handle_pos.y,
+                    splitter->priv->handle_pos.width,
+                    layout->handle_size);
+        }
+    }
+}
+
+static void
+ddb_splitter_size_allocate (GtkWidget *widget, GtkAllocation *allocation)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (widget);
+    GtkWidget *c1 = splitter->priv->child1;
+    GtkWidget *c2 = splitter->priv->child2;
+    gtk_widget_set_allocation (widget, allocation);
+    if (G_UNLIKELY (splitter->priv->virtualize || splitter->priv->virtual_ancestor)) {
+        ddb_splitter_virtual_update (splitter);
+    }
+
+    gint64 start = g_get_monotonic_time ();
+    gint64 child_allocate_time = splitter->priv->stats.child_allocate_time;
+    DDB_SPLITTER_TRACE_BEGIN (splitter, "size_allocate");
+    splitter->priv->stats.size_allocate_calls++;
+    if (G_UNLIKELY (thrash_limit)) {
+        ddb_splitter_thrash_begin (splitter);
+    }
+
+    gboolean child1_visible = c1 && gtk_widget_get_visible (c1) ? TRUE : FALSE;
+    gboolean child2_visible = c2 && gtk_widget_get_visible (c2) ? TRUE : FALSE;
+
+    /* GTK queues the resize for us when a child is shown or hidden */
+    for (guint i = 0; i < 2; i++) {
+        DdbSplitterChildInfo *info = &splitter->priv->info[i];
+        gboolean visible = i == 0 ? child1_visible : child2_visible;
+        if (info->allocated && info->visible != visible) {
+            splitter->priv->stats.resizes[DDB_SPLITTER_RESIZE_CAUSE_VISIBILITY]++;
+        }
+        info->visible = visible;
+    }
+
+    DdbSplitterLayout layout;
+    ddb_splitter_compute_layout (splitter, allocation, &layout);
+    ddb_splitter_apply_layout (splitter, &layout);
+
+    if (G_UNLIKELY (thrash_limit)) {
+        ddb_splitter_thrash_end (splitter);
+    }
+
+    splitter->priv->stats.allocate_time += g_get_monotonic_time () - start
+        - (splitter->priv->stats.child_allocate_time - child_allocate_time);
+    DDB_SPLITTER_TRACE_END (splitter, "size_allocate");
+}
+
+/* Resets the state of slot @pos to that of a fresh child */
+static void
+ddb_splitter_clear_child_info (DdbSplitter *splitter, guint pos)
+{
+    memset (&splitter->priv->info[pos], 0, sizeof (DdbSplitterChildInfo));
+    splitter->priv->info[pos].shrink = TRUE;
+    splitter->priv->info[pos].max_size = -1;
+    splitter->priv->info[pos].max_fraction = 1.0f;
+}
+
+/* Puts @child into slot @pos without queueing a resize */
+static void
+ddb_splitter_attach_child (DdbSplitter *splitter, GtkWidget *child, guint pos)
+{
+    ddb_splitter_clear_child_info (splitter, pos);
+    if (pos == 0) {
+        splitter->priv->child1 = child;
+    }
+    else {
+        splitter->priv->child2 = child;
+    }
+
+    gtk_widget_set_parent (child, GTK_WIDGET (splitter));
+    if (splitter->priv->heatmap) {
+        ddb_splitter_heat_connect (splitter, pos);
+    }
+
+    if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_STACK && pos != splitter->priv->active_child) {
+        gtk_widget_set_child_visible (child, FALSE);
+    }
+
+    /* realize the widget if required */
+    if (gtk_widget_get_realized (GTK_WIDGET (splitter)))
+        gtk_widget_realize (child);
+
+    /* map the widget if required */
+    if (gtk_widget_get_visible (GTK_WIDGET (splitter)) && gtk_widget_get_visible (child))
+    {
+        if (gtk_widget_get_mapped (GTK_WIDGET (splitter)))
+            gtk_widget_map (child);
+    }
+}
+
+/* Unparents @widget and clears its slot without queueing a resize */
+static void
+ddb_splitter_detach_child (DdbSplitter *splitter, GtkWidget *widget)
+{
+    gint pos = ddb_splitter_child_pos (splitter, widget);
+    if (pos >= 0) {
+        ddb_splitter_heat_disconnect (splitter, pos);
+        ddb_splitter_clip_remove (splitter, pos);
+    }
+    gtk_widget_unparent (widget);
+    if (splitter->priv->child1 == widget) {
+        splitter->priv->child1 = NULL;
+    }
+    else if (splitter->priv->child2 == widget) {
+        splitter->priv->child2 = NULL;
+    }
+}
+
+static void
+ddb_splitter_add (GtkContainer *container, GtkWidget *widget)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (container);
+
+    if (splitter->priv->child1 && splitter->priv->child2) {
+        // Splitter already full
+        return;
+    }
+
+    gint pos = splitter->priv->add_pos;
+    if (pos < 0) {
+        pos = splitter->priv->child1 ? 1 : 0;
+    }
+    else if ((pos == 0 && splitter->priv->child1) || (pos == 1 && splitter->priv->child2)) {
+        // Requested slot already taken
+        return;
+    }
+
+    ddb_splitter_attach_child (splitter, widget, pos);
+
+    ddb_splitter_queue_resize (splitter, DDB_SPLITTER_RESIZE_CAUSE_CHILDREN);
+    return;
+}
+
+static void
+ddb_splitter_remove (GtkContainer *container, GtkWidget *widget)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (container);
+
+    /* check if the widget was visible */
+    gboolean widget_was_visible = gtk_widget_get_visible (widget);
+
+    /* unparent and remove the widget */
+    ddb_splitter_detach_child (splitter, widget);
+
+    if (G_LIKELY (widget_was_visible))
+        ddb_splitter_queue_resize (splitter, DDB_SPLITTER_RESIZE_CAUSE_CHILDREN);
+}
+
+static void
+ddb_splitter_forall (GtkContainer *container,
+                     gboolean include_internals,
+                     GtkCallback callback,
+                     gpointer callback_data)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (container);
+    GtkWidget *c1 = splitter->priv->child1;
+    GtkWidget *c2 = splitter->priv->child2;
+
+    if (c1 && GTK_IS_WIDGET (c1)) {
+        (*callback) (c1, callback_data);
+    }
+    if (c2 && GTK_IS_WIDGET (c2)) {
+        (*callback) (c2, callback_data);
+    }
+}
+
+static void
+ddb_splitter_remove_child (DdbSplitter *splitter, guint child)
+{
+    if (child == 1 && splitter->priv->child1) {
+        ddb_splitter_remove (GTK_CONTAINER (splitter), splitter->priv->child1);
+    }
+    else if (child == 2 && splitter->priv->child2) {
+        ddb_splitter_remove (GTK_CONTAINER (splitter), splitter->priv->child2);
+    }
+}
+
+void
+ddb_splitter_remove_c1 (DdbSplitter *splitter)
+{
+    ddb_splitter_remove_child (splitter, 1);
+}
+
+void
+ddb_splitter_remove_c2 (DdbSplitter *splitter)
+{
+    ddb_splitter_remove_child (splitter, 2);
+}
+
+gboolean
+ddb_splitter_add_child_at_pos (DdbSplitter *splitter, GtkWidget *child, guint pos)
+{
+    if ((pos == 0 && splitter->priv->child1)
+            || (pos == 1 && splitter->priv->child2)
+            || pos > 1) {
+        return FALSE;
+    }
+
+    ddb_splitter_attach_child (splitter, child, pos);
+
+    ddb_splitter_queue_resize (splitter, DDB_SPLITTER_RESIZE_CAUSE_CHILDREN);
+    return TRUE;
+}
+
+/**
+ * ddb_splitter_swap_children:
+ * @splitter : a #DdbSplitter.
+ *
+ * Swaps the two children of @splitter. The children stay realized and
+ * mapped, and their sizes stay with them: a locked child remains locked
+ * and the proportion is mirrored. In stack mode the shown child stays
+ * shown.
+ **/
+void
+ddb_splitter_swap_children (DdbSplitter *splitter)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+
+    DdbSplitterPrivate *priv = splitter->priv;
+    if (!priv->child1 && !priv->child2) {
+        return;
+    }
+
+    GtkWidget *child = priv->child1;
+    priv->child1 = priv->child2;
+    priv->child2 = child;
+
+    guint size = priv->child1_size;
+    priv->child1_size = priv->child2_size;
+    priv->child2_size = size;
+
+    DdbSplitterChildInfo info = priv->info[0];
+    priv->info[0] = priv->info[1];
+    priv->info[1] = info;
+
+    g_object_freeze_notify (G_OBJECT (splitter));
+    if (priv->size_mode == DDB_SPLITTER_SIZE_MODE_LOCK_C1) {
+        priv->size_mode = DDB_SPLITTER_SIZE_MODE_LOCK_C2;
+        g_object_notify (G_OBJECT (splitter), "size_mode");
+    }
+    else if (priv->size_mode == DDB_SPLITTER_SIZE_MODE_LOCK_C2) {
+        priv->size_mode = DDB_SPLITTER_SIZE_MODE_LOCK_C1;
+        g_object_notify (G_OBJECT (splitter), "size_mode");
+    }
+    if (priv->proportion >= 0.0f && priv->proportion != 0.5f) {
+        priv->proportion = 1.0f - priv->proportion;
+        g_object_notify (G_OBJECT (splitter), "proportion");
+    }
+    if (priv->size_mode == DDB_SPLITTER_SIZE_MODE_STACK) {
+        /* the same child stays on top */
+        priv->active_child = !priv->active_child;
+        g_object_notify (G_OBJECT (splitter), "active-child");
+    }
+    g_object_thaw_notify (G_OBJECT (splitter));
+
+    ddb_splitter_queue_resize (splitter, DDB_SPLITTER_RESIZE_CAUSE_CHILDREN);
+}
+
+/**
+ * ddb_splitter_move_child:
+ * @splitter : the #DdbSplitter holding the child.
+ * @pos      : the slot of the child, 0 or 1.
+ * @dest     : the #DdbSplitter to move the child to, may be @splitter.
+ * @dest_pos : the slot in @dest, 0 or 1. It has to be empty.
+ *
+ * Moves a child to another slot without destroying its windows. Unlike
+ * removing and adding the child again, a realized child is not unrealized
+ * when @dest is realized as well, so its GdkWindows, GL contexts and
+ * caches survive the move. Its child properties move along with it.
+ *
+ * Returns: %TRUE if the child was moved.
+ **/
+gboolean
+ddb_splitter_move_child (DdbSplitter *splitter, guint pos, DdbSplitter *dest, guint dest_pos)
+{
+    g_return_val_if_fail (DDB_IS_SPLITTER (splitter), FALSE);
+    g_return_val_if_fail (DDB_IS_SPLITTER (dest), FALSE);
+    g_return_val_if_fail (pos < 2 && dest_pos < 2, FALSE);
+
+    GtkWidget *child = pos == 0 ? splitter->priv->child1 : splitter->priv->child2;
+    GtkWidget *dest_child = dest_pos == 0 ? dest->priv->child1 : dest->priv->child2;
+    guint size = pos == 0 ? splitter->priv->child1_size : splitter->priv->child2_size;
+
+    if (!child || dest_child) {
+        return FALSE;
+    }
+    if (child == GTK_WIDGET (dest) || gtk_widget_is_ancestor (GTK_WIDGET (dest), child)) {
+        // can't move a splitter into itself
+        return FALSE;
+    }
+
+    if (dest == splitter) {
+        // only the slot changes
+        splitter->priv->info[1 - pos] = splitter->priv->info[pos];
+        ddb_splitter_clear_child_info (splitter, pos);
+        if (pos == 0) {
+            splitter->priv->child1 = NULL;
+            splitter->priv->child2 = child;
+            splitter->priv->child2_size = size;
+        }
+        else {
+            splitter->priv->child2 = NULL;
+            splitter->priv->child1 = child;
+            splitter->priv->child1_size = size;
+        }
+        ddb_splitter_queue_resize (splitter, DDB_SPLITTER_RESIZE_CAUSE_CHILDREN);
+        return TRUE;
+    }
+
+    if (dest_pos == 0) {
+        dest->priv->child1_size = size;
+    }
+    else {
+        dest->priv->child2_size = size;
+    }
+
+    /* the child properties move along, what it was given and the heat
+     * map don't */
+    DdbSplitterChildInfo moved = splitter->priv->info[pos];
+
+    /* gtk_widget_reparent () moves the child's windows to the new parent
+     * instead of destroying and recreating them */
+    dest->priv->add_pos = dest_pos;
+    G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+    gtk_widget_reparent (child, GTK_WIDGET (dest));
+    G_GNUC_END_IGNORE_DEPRECATIONS
+    dest->priv->add_pos = -1;
+    if (gtk_widget_get_parent (child) != GTK_WIDGET (dest)) {
+        return FALSE;
+    }
+
+    DdbSplitterChildInfo *info = &dest->priv->info[dest_pos];
+    info->defer_allocation = moved.defer_allocation;
+    info->shrink = moved.shrink;
+    info->min_size = moved.min_size;
+    info->max_size = moved.max_size;
+    info->min_fraction = moved.min_fraction;
+    info->max_fraction = moved.max_fraction;
+    info->size_pending = moved.size_pending;
+    info->size_hinted = moved.size_hinted;
+    info->size_hint = moved.size_hint;
+    info->size_hint_basis[0] = moved.size_hint_basis[0];
+    info->size_hint_basis[1] = moved.size_hint_basis[1];
+    ddb_splitter_clip_update (dest, dest_pos);
+
+    if (gtk_widget_get_realized (child)) {
+        ddb_splitter_clip_repair (child, NULL);
+    }
+    return TRUE;
+}
+
+/* Shows both children again when the stack size mode is left */
+static void
+ddb_splitter_leave_stack (DdbSplitter *splitter)
+{
+    if (splitter->priv->unrealize_id) {
+        g_source_remove (splitter->priv->unrealize_id);
+        splitter->priv->unrealize_id = 0;
+    }
+    if (splitter->priv->child1) {
+        gtk_widget_set_child_visible (splitter->priv->child1, TRUE);
+    }
+    if (splitter->priv->child2) {
+        gtk_widget_set_child_visible (splitter->priv->child2, TRUE);
+    }
+}
+
+/**
+ * ddb_splitter_get_size_mode:
+ * @splitter : a #DdbSplitter.
+ *
+ * Returns the size mode of the splitter
+ *
+ * Returns: the size mode of @splitter.
+ **/
+DdbSplitterSizeMode
+ddb_splitter_get_size_mode (const DdbSplitter *splitter)
+{
+    g_return_val_if_fail (DDB_IS_SPLITTER (splitter), DDB_SPLITTER_SIZE_MODE_PROP);
+    return splitter->priv->size_mode;
+}
+
+/**
+ * ddb_splitter_set_size_mode:
+ * @splitter    : a #DdbSplitter.
+ * @size_mode : The size_mode of the splitter.
+ *
+ * Sets the size_mode of the @splitter
+ **/
+void
+ddb_splitter_set_size_mode (DdbSplitter *splitter, DdbSplitterSizeMode size_mode)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+
+    if (G_LIKELY (splitter->priv->size_mode != size_mode))
+    {
+        DDB_SPLITTER_TRACE_BEGIN (splitter, "set_size_mode");
+        /* an animation of the old mode means nothing in the new one */
+        ddb_splitter_animation_remove (splitter);
+        if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_STACK) {
+            ddb_splitter_leave_stack (splitter);
+        }
+        splitter->priv->size_mode = size_mode;
+        ddb_splitter_update_cursor (splitter);
+        ddb_splitter_queue_resize (splitter, DDB_SPLITTER_RESIZE_CAUSE_SIZE_MODE);
+        g_object_notify (G_OBJECT (splitter), "size_mode");
+        DDB_SPLITTER_TRACE_END (splitter, "set_size_mode");
+    }
+}
+
+/**
+ * ddb_splitter_get_orientation:
+ * @splitter : a #DdbSplitter.
+ *
+ * Returns the orientation of the splitter
+ *
+ * Returns: the orientation of @splitter.
+ **/
+GtkOrientation
+ddb_splitter_get_orientation (const DdbSplitter *splitter)
+{
+    g_return_val_if_fail (DDB_IS_SPLITTER (splitter), GTK_ORIENTATION_HORIZONTAL);
+    return splitter->priv->orientation;
+}
+
+/**
+ * ddb_splitter_set_orientation:
+ * @splitter    : a #DdbSplitter.
+ * @orientation : The orientation of the splitter.
+ *
+ * Sets the orientation of the @splitter
+ **/
+void
+ddb_splitter_set_orientation (DdbSplitter *splitter, GtkOrientation orientation)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+
+    if (G_LIKELY (splitter->priv->orientation != orientation))
+    {
+        DDB_SPLITTER_TRACE_BEGIN (splitter, "set_orientation");
+        splitter->priv->orientation = orientation;
+        ddb_splitter_queue_resize (splitter, DDB_SPLITTER_RESIZE_CAUSE_ORIENTATION);
+        g_object_notify (G_OBJECT (splitter), "orientation");
+        DDB_SPLITTER_TRACE_END (splitter, "set_orientation");
+    }
+}
+
+/**
+ * ddb_splitter_get_proportion:
+ * @splitter : a #DdbSplitter.
+ *
+ * Returns the proportion of the splitter
+ *
+ * Returns: the proportion of the @splitter.
+ **/
+gfloat
+ddb_splitter_get_proportion (const DdbSplitter *splitter)
+{
+    g_return_val_if_fail (DDB_IS_SPLITTER (splitter), 0.f);
+    return splitter->priv->proportion;
+}
+
+/**
+ * ddb_splitter_set_proportion:
+ * @splitter    : a #DdbSplitter.
+ * @proportion : The proportion how the child should be arranged.
+ *
+ * Sets the proportion of the @splitter. A running animation of the
+ * proportion is stopped.
+ **/
+void
+ddb_splitter_set_proportion (DdbSplitter *splitter, gfloat proportion)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+
+    if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_PROP) {
+        ddb_splitter_animation_remove (splitter);
+    }
+    if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_PROP
+           && G_LIKELY (splitter->priv->proportion != proportion))
+    {
+        DDB_SPLITTER_TRACE_BEGIN (splitter, "set_proportion");
+        splitter->priv->proportion = proportion;
+        ddb_splitter_queue_resize (splitter, DDB_SPLITTER_RESIZE_CAUSE_PROPORTION);
+        g_object_notify (G_OBJECT (splitter), "proportion");
+
+        if (splitter->priv->sync_group) {
+            _ddb_splitter_sync_group_propagate (splitter->priv->sync_group, splitter);
+        }
+        DDB_SPLITTER_TRACE_END (splitter, "set_proportion");
+    }
+}
+
+/**
+ * ddb_splitter_get_locked_size:
+ * @splitter : a #DdbSplitter.
+ *
+ * Returns the size of the locked child of the splitter
+ *
+ * Returns: the size of the locked child, or -1 if the size mode of
+ * @splitter is %DDB_SPLITTER_SIZE_MODE_PROP.
+ **/
+gint
+ddb_splitter_get_locked_size (const DdbSplitter *splitter)
+{
+    g_return_val_if_fail (DDB_IS_SPLITTER (splitter), -1);
+
+    switch (splitter->priv->size_mode) {
+        case DDB_SPLITTER_SIZE_MODE_LOCK_C1:
+            return splitter->priv->child1_size;
+        case DDB_SPLITTER_SIZE_MODE_LOCK_C2:
+            return splitter->priv->child2_size;
+        default:
+            return -1;
+    }
+}
+
+/**
+ * ddb_splitter_set_locked_size:
+ * @splitter    : a #DdbSplitter.
+ * @locked_size : The size of the locked child.
+ *
+ * Sets the size of the locked child of the @splitter. Has no effect
+ * if no child is locked, or if @locked_size is -1, which is what
+ * ddb_splitter_get_locked_size() returns in that case. A running
+ * animation of the size is stopped.
+ **/
+void
+ddb_splitter_set_locked_size (DdbSplitter *splitter, gint locked_size)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+    g_return_if_fail (locked_size >= -1);
+
+    if (locked_size < 0) {
+        return;
+    }
+
+    guint *size;
+    if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_LOCK_C1) {
+        size = &splitter->priv->child1_size;
+    }
+    else if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_LOCK_C2) {
+        size = &splitter->priv->child2_size;
+    }
+    else {
+        return;
+    }
+
+    ddb_splitter_animation_remove (splitter);
+    if (G_LIKELY (*size != (guint)locked_size))
+    {
+        DDB_SPLITTER_TRACE_BEGIN (splitter, "set_locked_size");
+        *size = locked_size;
+        ddb_splitter_queue_resize (splitter, DDB_SPLITTER_RESIZE_CAUSE_PROPORTION);
+        g_object_notify (G_OBJECT (splitter), "locked-size");
+
+        if (splitter->priv->sync_group) {
+            _ddb_splitter_sync_group_propagate (splitter->priv->sync_group, splitter);
+        }
+        DDB_SPLITTER_TRACE_END (splitter, "set_locked_size");
+    }
+}
+
+/* Applies all changes posted since the last run in one batch, on the
+ * main loop */
+static gboolean
+ddb_splitter_post_apply (gpointer user_data)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (user_data);
+    DdbSplitterPrivate *priv = splitter->priv;
+    gint pending = g_atomic_int_and (&priv->post_pending, 0);
+    union {
+        gint i;
+        gfloat f;
+    } proportion;
+
+    g_object_freeze_notify (G_OBJECT (splitter));
+    if (pending & DDB_SPLITTER_POST_SIZE_MODE) {
+        ddb_splitter_set_size_mode (splitter, g_atomic_int_get (&priv->post_size_mode));
+    }
+    if (pending & DDB_SPLITTER_POST_LOCKED_SIZE) {
+        ddb_splitter_set_locked_size (splitter, g_atomic_int_get (&priv->post_locked_size));
+    }
+    if (pending & DDB_SPLITTER_POST_PROPORTION) {
+        proportion.i = g_atomic_int_get (&priv->post_proportion);
+        ddb_splitter_set_proportion (splitter, proportion.f);
+    }
+    g_object_thaw_notify (G_OBJECT (splitter));
+
+    return FALSE;
+}
+
+/* Marks @change as pending and schedules the main loop to apply it, unless
+ * that's already scheduled */
+static void
+ddb_splitter_post (DdbSplitter *splitter, gint change)
+{
+    if (g_atomic_int_or (&splitter->priv->post_pending, change) == 0) {
+        /* run before GTK handles the queued resizes */
+        g_idle_add_full (G_PRIORITY_HIGH_IDLE, ddb_splitter_post_apply,
+                g_object_ref (splitter), g_object_unref);
+    }
+}
+
+/**
+ * ddb_splitter_post_proportion:
+ * @splitter   : a #DdbSplitter.
+ * @proportion : The proportion how the child should be arranged.
+ *
+ * Like ddb_splitter_set_proportion(), but may be called from any thread.
+ * The change is applied by the main loop. Posting several times before
+ * it runs only keeps the latest value, and all changes posted to
+ * @splitter are applied together with a single relayout.
+ *
+ * The caller has to make sure @splitter isn't finalized while posting.
+ **/
+void
+ddb_splitter_post_proportion (DdbSplitter *splitter, gfloat proportion)
+{
+    union {
+        gint i;
+        gfloat f;
+    } value;
+
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+
+    value.f = proportion;
+    g_atomic_int_set (&splitter->priv->post_proportion, value.i);
+    ddb_splitter_post (splitter, DDB_SPLITTER_POST_PROPORTION);
+}
+
+/**
+ * ddb_splitter_post_size_mode:
+ * @splitter  : a #DdbSplitter.
+ * @size_mode : The size mode of the splitter.
+ *
+ * Thread-safe variant of ddb_splitter_set_size_mode(), see
+ * ddb_splitter_post_proportion().
+ **/
+void
+ddb_splitter_post_size_mode (DdbSplitter *splitter, DdbSplitterSizeMode size_mode)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+
+    g_atomic_int_set (&splitter->priv->post_size_mode, size_mode);
+    ddb_splitter_post (splitter, DDB_SPLITTER_POST_SIZE_MODE);
+}
+
+/**
+ * ddb_splitter_post_locked_size:
+ * @splitter    : a #DdbSplitter.
+ * @locked_size : The size of the locked child.
+ *
+ * Thread-safe variant of ddb_splitter_set_locked_size(), see
+ * ddb_splitter_post_proportion(). A size mode posted along with it is
+ * applied first.
+ **/
+void
+ddb_splitter_post_locked_size (DdbSplitter *splitter, gint locked_size)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+    g_return_if_fail (locked_size >= -1);
+
+    if (locked_size < 0) {
+        return;
+    }
+
+    g_atomic_int_set (&splitter->priv->post_locked_size, locked_size);
+    ddb_splitter_post (splitter, DDB_SPLITTER_POST_LOCKED_SIZE);
+}
+
+/* Reallocates the children within the current allocation of @splitter,
+ * without queueing a resize on the toplevel */
+static void
+ddb_splitter_relayout (DdbSplitter *splitter)
+{
+    GtkWidget *widget = GTK_WIDGET (splitter);
+    GtkAllocation allocation;
+
+    if (!gtk_widget_get_visible (widget) || !gtk_widget_get_realized (widget)) {
+        return;
+    }
+
+    gtk_widget_get_allocation (widget, &allocation);
+    ddb_splitter_size_allocate (widget, &allocation);
+}
+
+static gfloat
+ddb_splitter_ease (DdbSplitterEasing easing, gfloat t)
+{
+    switch (easing) {
+        case DDB_SPLITTER_EASING_EASE_IN_OUT:
+            if (t < 0.5f) {
+                return 4.0f * t * t * t;
+            }
+            t = 2.0f - 2.0f * t;
+            return 1.0f - t * t * t / 2.0f;
+        case DDB_SPLITTER_EASING_EASE_OUT:
+            t = 1.0f - t;
+            return 1.0f - t * t * t;
+        default:
+            return t;
+    }
+}
+
+static void
+ddb_splitter_animation_remove (DdbSplitter *splitter)
+{
+    if (!splitter->priv->anim_id) {
+        return;
+    }
+#if GTK_CHECK_VERSION(3,8,0)
+    gtk_widget_remove_tick_callback (GTK_WIDGET (splitter), splitter->priv->anim_id);
+#else
+    g_source_remove (splitter->priv->anim_id);
+#endif
+    splitter->priv->anim_id = 0;
+}
+
+/* Ends the animation at the current value: the only resize request and
+ * property notification of the whole animation happen here */
+static void
+ddb_splitter_animation_finish (DdbSplitter *splitter)
+{
+    ddb_splitter_animation_remove (splitter);
+
+    ddb_splitter_queue_resize (splitter, DDB_SPLITTER_RESIZE_CAUSE_PROPORTION);
+    g_object_notify (G_OBJECT (splitter), splitter->priv->anim_locked ? "locked-size" : "proportion");
+
+    if (splitter->priv->sync_group) {
+        _ddb_splitter_sync_group_propagate (splitter->priv->sync_group, splitter);
+    }
+}
+
+static gboolean
+ddb_splitter_animation_step (DdbSplitter *splitter, gint64 now)
+{
+    DdbSplitterPrivate *priv = splitter->priv;
+    gfloat t = 1.0f;
+
+    if (priv->anim_duration > 0) {
+        t = CLAMP ((now - priv->anim_start) / (priv->anim_duration * 1000.0f), 0.0f, 1.0f);
+    }
+    gfloat value = priv->anim_from + (priv->anim_to - priv->anim_from) * ddb_splitter_ease (priv->anim_easing, t);
+
+    if (!priv->anim_locked) {
+        priv->proportion = value;
+    }
+    else if (priv->size_mode == DDB_SPLITTER_SIZE_MODE_LOCK_C1) {
+        priv->child1_size = (guint)(value + 0.5f);
+    }
+    else if (priv->size_mode == DDB_SPLITTER_SIZE_MODE_LOCK_C2) {
+        priv->child2_size = (guint)(value + 0.5f);
+    }
+
+    ddb_splitter_relayout (splitter);
+
+    if (t >= 1.0f) {
+        ddb_splitter_animation_finish (splitter);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+#if GTK_CHECK_VERSION(3,8,0)
+static gboolean
+ddb_splitter_animation_tick (GtkWidget *widget, GdkFrameClock *frame_clock, gpointer user_data)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (widget);
+    gboolean running = ddb_splitter_animation_step (splitter, gdk_frame_clock_get_frame_time (frame_clock));
+
+    if (!running) {
+        /* the tick callback is removed by returning G_SOURCE_REMOVE */
+        splitter->priv->anim_id = 0;
+    }
+    return running ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE;
+}
+#else
+static gboolean
+ddb_splitter_animation_timeout (gpointer user_data)
+{
+    DdbSplitter *splitter = DDB_SPLITTER (user_data);
+    gboolean running = ddb_splitter_animation_step (splitter, g_get_monotonic_time ());
+
+    if (!running) {
+        splitter->priv->anim_id = 0;
+    }
+    return running;
+}
+#endif
+
+static void
+ddb_splitter_animate (DdbSplitter *splitter,
+                      gboolean locked,
+                      gfloat from,
+                      gfloat to,
+                      guint duration,
+                      DdbSplitterEasing easing)
+{
+    DdbSplitterPrivate *priv = splitter->priv;
+
+    ddb_splitter_animation_remove (splitter);
+
+    priv->anim_locked = locked;
+    priv->anim_from = from;
+    priv->anim_to = to;
+    priv->anim_duration = duration;
+    priv->anim_easing = easing;
+#if GTK_CHECK_VERSION(3,8,0)
+    GdkFrameClock *frame_clock = gtk_widget_get_frame_clock (GTK_WIDGET (splitter));
+    priv->anim_start = frame_clock ? gdk_frame_clock_get_frame_time (frame_clock) : g_get_monotonic_time ();
+    priv->anim_id = gtk_widget_add_tick_callback (GTK_WIDGET (splitter),
+            ddb_splitter_animation_tick, NULL, NULL);
+#else
+    priv->anim_start = g_get_monotonic_time ();
+    priv->anim_id = g_timeout_add (1000 / 60, ddb_splitter_animation_timeout, splitter);
+#endif
+}
+
+/**
+ * ddb_splitter_animate_proportion:
+ * @splitter   : a #DdbSplitter.
+ * @proportion : the final proportion.
+ * @duration   : the duration of the animation in milliseconds.
+ * @easing     : the #DdbSplitterEasing of the animation.
+ *
+ * Moves the handle of @splitter to @proportion over @duration
+ * milliseconds. Every frame only reallocates the children of @splitter
+ * within its current allocation; the resize request and the
+ * notification of #DdbSplitter:proportion happen once the animation
+ * is done. Only applies to the %DDB_SPLITTER_SIZE_MODE_PROP size mode.
+ **/
+void
+ddb_splitter_animate_proportion (DdbSplitter *splitter,
+                                 gfloat proportion,
+                                 guint duration,
+                                 DdbSplitterEasing easing)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+
+    if (splitter->priv->size_mode != DDB_SPLITTER_SIZE_MODE_PROP) {
+        return;
+    }
+    if (duration == 0 || !gtk_widget_get_mapped (GTK_WIDGET (splitter))) {
+        ddb_splitter_stop_animation (splitter);
+        ddb_splitter_set_proportion (splitter, proportion);
+        return;
+    }
+
+    ddb_splitter_animate (splitter, FALSE, splitter->priv->proportion, proportion, duration, easing);
+}
+
+/**
+ * ddb_splitter_animate_locked_size:
+ * @splitter    : a #DdbSplitter.
+ * @locked_size : the final size of the locked child.
+ * @duration    : the duration of the animation in milliseconds.
+ * @easing      : the #DdbSplitterEasing of the animation.
+ *
+ * Like ddb_splitter_animate_proportion(), but animates the size of the
+ * locked child, e.g. to slide a sidebar open or closed. Has no effect
+ * if no child is locked or @locked_size is -1.
+ **/
+void
+ddb_splitter_animate_locked_size (DdbSplitter *splitter,
+                                  gint locked_size,
+                                  guint duration,
+                                  DdbSplitterEasing easing)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+    g_return_if_fail (locked_size >= -1);
+
+    gint from = ddb_splitter_get_locked_size (splitter);
+    if (from < 0 || locked_size < 0) {
+        return;
+    }
+    if (duration == 0 || !gtk_widget_get_mapped (GTK_WIDGET (splitter))) {
+        ddb_splitter_stop_animation (splitter);
+        ddb_splitter_set_locked_size (splitter, locked_size);
+        return;
+    }
+
+    ddb_splitter_animate (splitter, TRUE, from, locked_size, duration, easing);
+}
+
+/**
+ * ddb_splitter_stop_animation:
+ * @splitter : a #DdbSplitter.
+ *
+ * Stops a running animation, leaving the handle where it currently is.
+ **/
+void
+ddb_splitter_stop_animation (DdbSplitter *splitter)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+
+    if (splitter->priv->anim_id) {
+        ddb_splitter_animation_finish (splitter);
+    }
+}
+
+/**
+ * ddb_splitter_get_active_child:
+ * @splitter : a #DdbSplitter.
+ *
+ * Returns: the slot of the child shown in the
+ * %DDB_SPLITTER_SIZE_MODE_STACK size mode.
+ **/
+guint
+ddb_splitter_get_active_child (const DdbSplitter *splitter)
+{
+    g_return_val_if_fail (DDB_IS_SPLITTER (splitter), 0);
+    return splitter->priv->active_child;
+}
+
+/**
+ * ddb_splitter_set_active_child:
+ * @splitter : a #DdbSplitter.
+ * @pos      : the slot of the child to show, 0 or 1.
+ *
+ * Selects the child shown in the %DDB_SPLITTER_SIZE_MODE_STACK size mode.
+ * In that mode the switch only re-allocates the splitter itself; the
+ * child being hidden is just unmapped, and unrealized once
+ * #DdbSplitter:unrealize-timeout passes.
+ **/
+void
+ddb_splitter_set_active_child (DdbSplitter *splitter, guint pos)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+    g_return_if_fail (pos < 2);
+
+    if (splitter->priv->active_child != pos) {
+        splitter->priv->active_child = pos;
+        if (splitter->priv->unrealize_id) {
+            g_source_remove (splitter->priv->unrealize_id);
+            splitter->priv->unrealize_id = 0;
+        }
+        if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_STACK) {
+            ddb_splitter_relayout (splitter);
+        }
+        g_object_notify (G_OBJECT (splitter), "active-child");
+    }
+}
+
+/**
+ * ddb_splitter_get_unrealize_timeout:
+ * @splitter : a #DdbSplitter.
+ *
+ * Returns: how long the inactive child stays realized in the
+ * %DDB_SPLITTER_SIZE_MODE_STACK size mode, in milliseconds, or -1.
+ **/
+gint
+ddb_splitter_get_unrealize_timeout (const DdbSplitter *splitter)
+{
+    g_return_val_if_fail (DDB_IS_SPLITTER (splitter), -1);
+    return splitter->priv->unrealize_timeout;
+}
+
+/**
+ * ddb_splitter_set_unrealize_timeout:
+ * @splitter : a #DdbSplitter.
+ * @timeout  : the time in milliseconds, or -1 to never unrealize.
+ *
+ * Sets how long the inactive child stays realized after it was hidden
+ * in the %DDB_SPLITTER_SIZE_MODE_STACK size mode. Unrealizing frees its
+ * windows and other resources, at the cost of realizing it again when
+ * it is shown.
+ **/
+void
+ddb_splitter_set_unrealize_timeout (DdbSplitter *splitter, gint timeout)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+    g_return_if_fail (timeout >= -1);
+
+    if (splitter->priv->unrealize_timeout != timeout) {
+        splitter->priv->unrealize_timeout = timeout;
+        if (splitter->priv->unrealize_id) {
+            g_source_remove (splitter->priv->unrealize_id);
+            splitter->priv->unrealize_id = 0;
+        }
+        if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_STACK) {
+            ddb_splitter_relayout (splitter);
+        }
+        g_object_notify (G_OBJECT (splitter), "unrealize-timeout");
+    }
+}
+
+/**
+ * ddb_splitter_get_heatmap:
+ * @splitter : a #DdbSplitter.
+ *
+ * Returns: whether @splitter shows the heat-map overlay.
+ **/
+gboolean
+ddb_splitter_get_heatmap (const DdbSplitter *splitter)
+{
+    g_return_val_if_fail (DDB_IS_SPLITTER (splitter), FALSE);
+    return splitter->priv->heatmap;
+}
+
+/**
+ * ddb_splitter_set_heatmap:
+ * @splitter : a #DdbSplitter.
+ * @heatmap  : whether to show the overlay.
+ *
+ * Shows or hides a debug overlay that tints each child by how often it
+ * was allocated (red) and repainted (blue) during the last second, prints
+ * those rates along with the time its last allocation took, and flashes
+ * the handle when it moves. Children with their own window cover the
+ * tint, but not the handle flash.
+ **/
+void
+ddb_splitter_set_heatmap (DdbSplitter *splitter, gboolean heatmap)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+
+    heatmap = heatmap ? TRUE : FALSE;
+    if (splitter->priv->heatmap == heatmap) {
+        return;
+    }
+
+    splitter->priv->heatmap = heatmap;
+    for (guint i = 0; i < 2; i++) {
+        if (heatmap) {
+            memset (splitter->priv->info[i].heat_allocations, 0, sizeof (splitter->priv->info[i].heat_allocations));
+            memset (splitter->priv->info[i].heat_paints, 0, sizeof (splitter->priv->info[i].heat_paints));
+            ddb_splitter_heat_connect (splitter, i);
+        }
+        else {
+            ddb_splitter_heat_disconnect (splitter, i);
+        }
+    }
+    if (!heatmap) {
+        ddb_splitter_heat_stop (splitter);
+    }
+    gtk_widget_queue_draw (GTK_WIDGET (splitter));
+    g_object_notify (G_OBJECT (splitter), "heatmap");
+}
+
+/**
+ * ddb_splitter_get_virtualize:
+ * @splitter : a #DdbSplitter.
+ *
+ * Returns: whether @splitter skips children that are out of view.
+ **/
+gboolean
+ddb_splitter_get_virtualize (const DdbSplitter *splitter)
+{
+    g_return_val_if_fail (DDB_IS_SPLITTER (splitter), FALSE);
+    return splitter->priv->virtualize;
+}
+
+/**
+ * ddb_splitter_set_virtualize:
+ * @splitter   : a #DdbSplitter.
+ * @virtualize : whether to skip children out of view.
+ *
+ * For large layouts in a #GtkScrolledWindow. When set, children of
+ * @splitter and of the nested splitters below it that are entirely
+ * scrolled out of view of the enclosing #GtkViewport are unmapped and
+ * no longer allocated, until they scroll back into view. Scrolling then
+ * only costs as much as the children coming into and going out of view.
+ **/
+void
+ddb_splitter_set_virtualize (DdbSplitter *splitter, gboolean virtualize)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+
+    virtualize = virtualize ? TRUE : FALSE;
+    if (splitter->priv->virtualize != virtualize) {
+        splitter->priv->virtualize = virtualize;
+        ddb_splitter_virtual_refresh (splitter);
+        g_object_notify (G_OBJECT (splitter), "virtualize");
+    }
+}
+
+/**
+ * ddb_splitter_get_copy_on_move:
+ * @splitter : a #DdbSplitter.
+ *
+ * Returns: whether children of @splitter that only move are copied
+ * instead of repainted.
+ **/
+gboolean
+ddb_splitter_get_copy_on_move (const DdbSplitter *splitter)
+{
+    g_return_val_if_fail (DDB_IS_SPLITTER (splitter), FALSE);
+    return splitter->priv->copy_on_move;
+}
+
+/**
+ * ddb_splitter_set_copy_on_move:
+ * @splitter     : a #DdbSplitter.
+ * @copy_on_move : whether to copy children that only move.
+ *
+ * When a child keeps its size but changes its position, e.g. the locked
+ * child in #DDB_SPLITTER_SIZE_MODE_LOCK_C2 mode while the window is
+ * resized, the splitter moves what the child shows with
+ * gdk_window_move_region() and only the uncovered strip gets repainted.
+ * Only applies to children without a window of their own; those are
+ * moved by GDK anyway. Switch it off for children whose contents depend
+ * on their position, e.g. with a background aligned to the toplevel.
+ * Splitters nested in a child that is copied leave their own children
+ * to that copy. On by default.
+ *
+ * With GTK 3.16 and later, windows don't keep what they show and
+ * gdk_window_move_region() only invalidates, so children are always
+ * repainted and this setting has no effect.
+ **/
+void
+ddb_splitter_set_copy_on_move (DdbSplitter *splitter, gboolean copy_on_move)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+
+    copy_on_move = copy_on_move ? TRUE : FALSE;
+    if (splitter->priv->copy_on_move != copy_on_move) {
+        splitter->priv->copy_on_move = copy_on_move;
+        g_object_notify (G_OBJECT (splitter), "copy-on-move");
+    }
+}
+
+/**
+ * ddb_splitter_get_defer_interval:
+ * @splitter : a #DdbSplitter.
+ *
+ * Returns: how often deferred children are resized while @splitter
+ * is being resized, in milliseconds.
+ **/
+guint
+ddb_splitter_get_defer_interval (const DdbSplitter *splitter)
+{
+    g_return_val_if_fail (DDB_IS_SPLITTER (splitter), 0);
+    return splitter->priv->defer_interval;
+}
+
+/**
+ * ddb_splitter_set_defer_interval:
+ * @splitter : a #DdbSplitter.
+ * @interval : the interval in milliseconds, 0 to wait until the size
+ *             stops changing.
+ *
+ * Sets how often children with #DdbSplitter:defer-allocation set get a
+ * new size while @splitter is being resized.
+ **/
+void
+ddb_splitter_set_defer_interval (DdbSplitter *splitter, guint interval)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+
+    if (splitter->priv->defer_interval != interval) {
+        splitter->priv->defer_interval = interval;
+        g_object_notify (G_OBJECT (splitter), "defer-interval");
+    }
+}
+
+/* Computes the size @splitter would request now, using the current
+ * hints of its children */
+static void
+ddb_splitter_current_request (DdbSplitter *splitter, GtkRequisition *requisition)
+{
+#if GTK_CHECK_VERSION(3,0,0)
+    gint minimum;
+    ddb_splitter_get_preferred_width (GTK_WIDGET (splitter), &minimum, &requisition->width);
+    ddb_splitter_get_preferred_height (GTK_WIDGET (splitter), &minimum, &requisition->height);
+#else
+    requisition->width = 0;
+    requisition->height = 0;
+    ddb_splitter_size_request (GTK_WIDGET (splitter), requisition);
+#endif
+}
+
+/**
+ * ddb_splitter_set_child_size_pending:
+ * @splitter : a #DdbSplitter.
+ * @child    : a child of @splitter.
+ * @width    : the width to reserve for @child.
+ * @height   : the height to reserve for @child.
+ *
+ * Declares that the size of @child isn't known yet, e.g. because it
+ * waits for an image to be decoded. Whatever @child requests meanwhile,
+ * the splitter lays it out as if it had requested @width x @height, until
+ * ddb_splitter_child_size_hint_ready() or
+ * ddb_splitter_clear_child_size_hint() is called. @child is still asked
+ * for its size request, so it should answer cheaply while it is pending.
+ **/
+void
+ddb_splitter_set_child_size_pending (DdbSplitter *splitter, GtkWidget *child, gint width, gint height)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+    g_return_if_fail (width >= 0 && height >= 0);
+
+    gint pos = ddb_splitter_child_pos (splitter, child);
+    g_return_if_fail (pos >= 0);
+
+    DdbSplitterChildInfo *info = &splitter->priv->info[pos];
+    gboolean changed = !(info->size_pending || info->size_hinted)
+        || info->size_hint.width != width || info->size_hint.height != height;
+
+    info->size_pending = TRUE;
+    info->size_hinted = FALSE;
+    info->size_hint.width = width;
+    info->size_hint.height = height;
+    if (changed) {
+        ddb_splitter_queue_resize (splitter, DDB_SPLITTER_RESIZE_CAUSE_LAYOUT);
+    }
+}
+
+/**
+ * ddb_splitter_child_size_hint_ready:
+ * @splitter : a #DdbSplitter.
+ * @child    : a child of @splitter.
+ * @width    : the width @child wants.
+ * @height   : the height @child wants.
+ *
+ * Provides the size of @child once it is known. The splitter uses the
+ * hint as size request of @child until the request of @child itself
+ * changes, e.g. because it queued a resize with its real size, or until
+ * ddb_splitter_clear_child_size_hint() is called.
+ *
+ * If @child is the locked child, the hint becomes the new locked size.
+ * When the hint changes the size request of the splitter a resize is
+ * queued. Otherwise only the splitter itself is re-allocated, if the
+ * split changed at all.
+ **/
+void
+ddb_splitter_child_size_hint_ready (DdbSplitter *splitter, GtkWidget *child, gint width, gint height)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+    g_return_if_fail (width >= 0 && height >= 0);
+
+    gint pos = ddb_splitter_child_pos (splitter, child);
+    g_return_if_fail (pos >= 0);
+
+    DdbSplitterPrivate *priv = splitter->priv;
+    DdbSplitterChildInfo *info = &priv->info[pos];
+    info->size_hint_basis[0] = -1;
+    info->size_hint_basis[1] = -1;
+    if ((info->size_pending || info->size_hinted)
+            && info->size_hint.width == width && info->size_hint.height == height) {
+        info->size_pending = FALSE;
+        info->size_hinted = TRUE;
+        return;
+    }
+
+    GtkRequisition old_req;
+    ddb_splitter_current_request (splitter, &old_req);
+
+    info->size_pending = FALSE;
+    info->size_hinted = TRUE;
+    info->size_hint.width = width;
+    info->size_hint.height = height;
+
+    gboolean split_changed = FALSE;
+    if ((pos == 0 && priv->size_mode == DDB_SPLITTER_SIZE_MODE_LOCK_C1)
+            || (pos == 1 && priv->size_mode == DDB_SPLITTER_SIZE_MODE_LOCK_C2)) {
+        guint *size = pos == 0 ? &priv->child1_size : &priv->child2_size;
+        guint locked_size = priv->orientation == GTK_ORIENTATION_HORIZONTAL ? width : height;
+        if (*size != locked_size) {
+            *size = locked_size;
+            split_changed = TRUE;
+            g_object_notify (G_OBJECT (splitter), "locked-size");
+            if (priv->sync_group) {
+                _ddb_splitter_sync_group_propagate (priv->sync_group, splitter);
+            }
+        }
+    }
+
+    /* the parent only needs to know if our request changed */
+    GtkRequisition req;
+    ddb_splitter_current_request (splitter, &req);
+    if (req.width != old_req.width || req.height != old_req.height) {
+        ddb_splitter_queue_resize (splitter, DDB_SPLITTER_RESIZE_CAUSE_LAYOUT);
+    }
+    else if (split_changed) {
+        ddb_splitter_relayout (splitter);
+    }
+}
+
+/**
+ * ddb_splitter_clear_child_size_hint:
+ * @splitter : a #DdbSplitter.
+ * @child    : a child of @splitter.
+ *
+ * Drops a pending size or a ready hint of @child, the splitter uses the
+ * size request of @child itself again.
+ **/
+void
+ddb_splitter_clear_child_size_hint (DdbSplitter *splitter, GtkWidget *child)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+
+    gint pos = ddb_splitter_child_pos (splitter, child);
+    g_return_if_fail (pos >= 0);
+
+    DdbSplitterChildInfo *info = &splitter->priv->info[pos];
+    if (!info->size_pending && !info->size_hinted) {
+        return;
+    }
+    info->size_pending = FALSE;
+    info->size_hinted = FALSE;
+    ddb_splitter_queue_resize (splitter, DDB_SPLITTER_RESIZE_CAUSE_LAYOUT);
+}
+
+/**
+ * ddb_splitter_get_stats:
+ * @splitter : a #DdbSplitter.
+ * @stats    : return location for the statistics.
+ *
+ * Copies the performance counters of @splitter into @stats. The counters
+ * are always kept and cover the time since the splitter was created or
+ * ddb_splitter_reset_stats() was called.
+ *
+ * Setting the environment variable DDB_SPLITTER_STATS prints the counters
+ * of all splitters when the program exits.
+ **/
+void
+ddb_splitter_get_stats (const DdbSplitter *splitter, DdbSplitterStats *stats)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+    g_return_if_fail (stats != NULL);
+
+    *stats = splitter->priv->stats;
+}
+
+/**
+ * ddb_splitter_reset_stats:
+ * @splitter : a #DdbSplitter.
+ *
+ * Sets all performance counters of @splitter to zero.
+ **/
+void
+ddb_splitter_reset_stats (DdbSplitter *splitter)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+
+    memset (&splitter->priv->stats, 0, sizeof (DdbSplitterStats));
+}
+
+static void
+ddb_splitter_subtree_stats_cb (GtkWidget *widget, gpointer user_data)
+{
+    DdbSplitterStats *stats = user_data;
+
+    if (DDB_IS_SPLITTER (widget)) {
+        DdbSplitter *splitter = DDB_SPLITTER (widget);
+        if (stats) {
+            ddb_splitter_stats_add (stats, &splitter->priv->stats);
+        }
+        else {
+            ddb_splitter_reset_stats (splitter);
+        }
+    }
+    if (GTK_IS_CONTAINER (widget)) {
+        gtk_container_forall (GTK_CONTAINER (widget), ddb_splitter_subtree_stats_cb, user_data);
+    }
+}
+
+/**
+ * ddb_splitter_get_subtree_stats:
+ * @widget : the root of the subtree, doesn't need to be a #DdbSplitter.
+ * @stats  : return location for the statistics.
+ *
+ * Sums up the performance counters of all splitters in the widget tree
+ * rooted at @widget. Note that allocate_time excludes the time spent in
+ * child allocations, so it can be summed up without counting nested
+ * splitters twice.
+ **/
+void
+ddb_splitter_get_subtree_stats (GtkWidget *widget, DdbSplitterStats *stats)
+{
+    g_return_if_fail (GTK_IS_WIDGET (widget));
+    g_return_if_fail (stats != NULL);
+
+    memset (stats, 0, sizeof (DdbSplitterStats));
+    ddb_splitter_subtree_stats_cb (widget, stats);
+}
+
+/**
+ * ddb_splitter_reset_subtree_stats:
+ * @widget : the root of the subtree, doesn't need to be a #DdbSplitter.
+ *
+ * Resets the performance counters of all splitters in the widget tree
+ * rooted at @widget.
+ **/
+void
+ddb_splitter_reset_subtree_stats (GtkWidget *widget)
+{
+    g_return_if_fail (GTK_IS_WIDGET (widget));
+
+    ddb_splitter_subtree_stats_cb (widget, NULL);
+}
+
+/**
+ * ddb_splitter_set_thrash_detection:
+ * @max_allocations    : the number of allocations a splitter may get in
+ *                       one frame, or 0 to turn detection off.
+ * @break_on_detection : whether to break into the debugger on detection.
+ *
+ * Enables a debug mode that warns about layouts which don't settle:
+ * splitters allocated more than @max_allocations times within a frame,
+ * and splitters whose proportion or locked size keeps flipping between
+ * two values within a frame. The warning names the child that last changed its size
+ * request. Detections are counted in the thrash_detections statistic.
+ *
+ * The mode can also be enabled by setting DDB_SPLITTER_THRASH to the
+ * allocation limit, and DDB_SPLITTER_THRASH_BREAK to break into the
+ * debugger.
+ **/
+void
+ddb_splitter_set_thrash_detection (guint max_allocations, gboolean break_on_detection)
+{
+    thrash_limit = max_allocations;
+    thrash_break = break_on_detection;
+}
+
+/**
+ * ddb_splitter_get_sync_group:
+ * @splitter : a #DdbSplitter.
+ *
+ * Returns: (transfer none): the sync group of @splitter, or %NULL.
+ **/
+DdbSplitterSyncGroup *
+ddb_splitter_get_sync_group (const DdbSplitter *splitter)
+{
+    g_return_val_if_fail (DDB_IS_SPLITTER (splitter), NULL);
+    return splitter->priv->sync_group;
+}
+
+/**
+ * ddb_splitter_set_sync_group:
+ * @splitter : a #DdbSplitter.
+ * @group    : (allow-none): a #DdbSplitterSyncGroup, or %NULL.
+ *
+ * Makes @splitter share its proportion and locked size with the other
+ * members of @group. Passing %NULL removes @splitter from its group.
+ **/
+void
+ddb_splitter_set_sync_group (DdbSplitter *splitter, DdbSplitterSyncGroup *group)
+{
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+    g_return_if_fail (group == NULL || DDB_IS_SPLITTER_SYNC_GROUP (group));
+
+    DdbSplitterSyncGroup *old_group = splitter->priv->sync_group;
+    if (old_group == group) {
+        return;
+    }
+
+    if (old_group) {
+        splitter->priv->sync_group = NULL;
+        _ddb_splitter_sync_group_detach (old_group, splitter);
+        g_object_unref (old_group);
+    }
+    if (group) {
+        splitter->priv->sync_group = g_object_ref (group);
+        _ddb_splitter_sync_group_attach (group, splitter);
+    }
+
+    g_object_notify (G_OBJECT (splitter), "sync-group");
+}
+
+/**
+ * ddb_splitter_error_quark:
+ *
+ * Returns: the error domain of errors reported by #DdbSplitter.
+ **/
+GQuark
+ddb_splitter_error_quark (void)
+{
+    return g_quark_from_static_string ("ddb-splitter-error-quark");
+}
+
+/*
+ * Layout descriptions
+ *
+ * A splitter tree is serialized as
+ *
+ *   node     := splitter | slot | '-'
+ *   splitter := '(' orientation ',' mode ',' proportion ',' size1 ',' size2 ',' node ',' node ')'
+ *   mode     := token | 'stack' ':' ('0' | '1')
+ *
+ * where orientation is 'h' or 'v', token is the token of a
+ * #DdbSplitterSizeMode, the digit after "stack" is the active child (0 if
+ * left out), size1 and size2 are the locked sizes of the children, slot
+ * is an identifier made of [A-Za-z0-9_.:-] and '-' marks an empty slot.
+ * Whitespace between tokens is ignored.
+ */
+typedef struct _DdbSplitterDescNode DdbSplitterDescNode;
+
+struct _DdbSplitterDescNode
+{
+    gboolean is_splitter;
+
+    /* leaf */
+    gchar *slot_id;
+    GtkWidget *widget;
+
+    /* splitter */
+    GtkOrientation orientation;
+    DdbSplitterSizeMode size_mode;
+    guint active_child;
+    gfloat proportion;
+    guint child1_size;
+    guint child2_size;
+    DdbSplitterDescNode *children[2];
+};
+
+typedef struct
+{
+    const gchar *desc;
+    const gchar *p;
+    GError **error;
+} DdbSplitterDescParser;
+
+static void
+ddb_splitter_desc_node_free (DdbSplitterDescNode *node)
+{
+    if (!node) {
+        return;
+    }
+    ddb_splitter_desc_node_free (node->children[0]);
+    ddb_splitter_desc_node_free (node->children[1]);
+    if (node->widget) {
+        g_object_unref (node->widget);
+    }
+    g_free (node->slot_id);
+    g_free (node);
+}
+
+static gboolean
+ddb_splitter_desc_is_slot_char (gchar c)
+{
+    return g_ascii_isalnum (c) || c == '_' || c == '.' || c == ':' || c == '-';
+}
 
-        if (splitter->priv->child1)
-            gtk_widget_set_child_visible (splitter->priv->child1, TRUE);
-        if (splitter->priv->child2)
-            gtk_widget_set_child_visible (splitter->priv->child2, TRUE);
+static void
+ddb_splitter_desc_skip_ws (DdbSplitterDescParser *parser)
+{
+    while (*parser->p && g_ascii_isspace (*parser->p)) {
+        parser->p++;
+    }
+}
 
-        child_allocation.x = allocation->x + border_width;
-        child_allocation.y = allocation->y + border_width;
-        child_allocation.width = MAX (1, con_width);
-        child_allocation.height = MAX (1, con_height);
+static gboolean
+ddb_splitter_desc_fail (DdbSplitterDescParser *parser, const gchar *expected)
+{
+    g_set_error (parser->error, DDB_SPLITTER_ERROR, DDB_SPLITTER_ERROR_PARSE,
+            "Invalid layout description at offset %d: expected %s",
+            (gint)(parser->p - parser->desc), expected);
+    return FALSE;
+}
 
-        if (splitter->priv->child1 && gtk_widget_get_visible (splitter->priv->child1))
-            gtk_widget_size_allocate (splitter->priv->child1, &child_allocation);
-        else if (splitter->priv->child2 && gtk_widget_get_visible (splitter->priv->child2))
-            gtk_widget_size_allocate (splitter->priv->child2, &child_allocation);
+static gboolean
+ddb_splitter_desc_expect (DdbSplitterDescParser *parser, gchar c)
+{
+    ddb_splitter_desc_skip_ws (parser);
+    if (*parser->p != c) {
+        gchar expected[4] = { '\'', c, '\'', '\0' };
+        return ddb_splitter_desc_fail (parser, expected);
     }
+    parser->p++;
+    return TRUE;
+}
 
-    if (gtk_widget_get_mapped (widget) &&
-            (old_handle_pos.x != splitter->priv->handle_pos.x ||
-             old_handle_pos.y != splitter->priv->handle_pos.y ||
-             old_handle_pos.width != splitter->priv->handle_pos.width ||
-             old_handle_pos.height != splitter->priv->handle_pos.height))
-    {
-        GdkWindow *window = gtk_widget_get_window (widget);
-        gdk_window_invalidate_rect (window, &old_handle_pos, FALSE);
-        gdk_window_invalidate_rect (window, &splitter->priv->handle_pos, FALSE);
+/* Reads a run of slot characters, returns its length */
+static gsize
+ddb_splitter_desc_token (DdbSplitterDescParser *parser, const gchar **start)
+{
+    ddb_splitter_desc_skip_ws (parser);
+    *start = parser->p;
+    while (*parser->p && ddb_splitter_desc_is_slot_char (*parser->p)) {
+        parser->p++;
     }
+    return parser->p - *start;
+}
 
-    if (gtk_widget_get_realized (widget)) {
-        if (gtk_widget_get_mapped (widget))
-            gdk_window_show (splitter->priv->handle);
+static gboolean
+ddb_splitter_desc_uint (DdbSplitterDescParser *parser, guint *value)
+{
+    const gchar *start;
+    gchar *end;
+    gsize len = ddb_splitter_desc_token (parser, &start);
+    guint64 v = g_ascii_strtoull (start, &end, 10);
+
+    if (len == 0 || end != parser->p || v > G_MAXINT) {
+        parser->p = start;
+        return ddb_splitter_desc_fail (parser, "a size");
+    }
+    *value = (guint)v;
+    return TRUE;
+}
 
-        if (splitter->priv->orientation == GTK_ORIENTATION_HORIZONTAL)
-        {
-            gdk_window_move_resize (splitter->priv->handle,
-                    splitter->priv->handle_pos.x,
-                    splitter->priv->handle_pos.y,
-                    handle_size,
-                    splitter->priv->handle_pos.height);
+static DdbSplitterDescNode *
+ddb_splitter_desc_parse_node (DdbSplitterDescParser *parser)
+{
+    DdbSplitterDescNode *node;
+    const gchar *start;
+    gsize len;
+
+    ddb_splitter_desc_skip_ws (parser);
+    if (*parser->p != '(') {
+        len = ddb_splitter_desc_token (parser, &start);
+        if (len == 0) {
+            ddb_splitter_desc_fail (parser, "'(' or a slot identifier");
+            return NULL;
         }
-        else {
-            gdk_window_move_resize (splitter->priv->handle,
-                    splitter->priv->handle_pos.x,
-                    splitter->priv->handle_pos.y,
-                    splitter->priv->handle_pos.width,
-                    handle_size);
+        node = g_new0 (DdbSplitterDescNode, 1);
+        if (len != 1 || *start != '-') {
+            node->slot_id = g_strndup (start, len);
         }
+        return node;
     }
+    parser->p++;
 
-}
-
-static void
-ddb_splitter_add (GtkContainer *container, GtkWidget *widget)
-{
-    DdbSplitter *splitter = DDB_SPLITTER (container);
+    node = g_new0 (DdbSplitterDescNode, 1);
+    node->is_splitter = TRUE;
 
-    if (splitter->priv->child1 && splitter->priv->child2) {
-        // Splitter already full
-        return;
+    len = ddb_splitter_desc_token (parser, &start);
+    if (len == 1 && *start == 'h') {
+        node->orientation = GTK_ORIENTATION_HORIZONTAL;
+    }
+    else if (len == 1 && *start == 'v') {
+        node->orientation = GTK_ORIENTATION_VERTICAL;
+    }
+    else {
+        parser->p = start;
+        ddb_splitter_desc_fail (parser, "'h' or 'v'");
+        goto error;
     }
 
-    gtk_widget_set_parent (widget, GTK_WIDGET (splitter));
-
-    if (!splitter->priv->child1) {
-        splitter->priv->child1 = widget;
+    if (!ddb_splitter_desc_expect (parser, ',')) {
+        goto error;
+    }
+    len = ddb_splitter_desc_token (parser, &start);
+    const gchar *active = memchr (start, ':', len);
+    if (!ddb_splitter_size_mode_from_token (start, active ? (gsize)(active - start) : len, &node->size_mode)) {
+        parser->p = start;
+        ddb_splitter_desc_fail (parser, "a size mode");
+        goto error;
     }
-    else if (!splitter->priv->child2) {
-        splitter->priv->child2 = widget;
+    if (active) {
+        if (node->size_mode != DDB_SPLITTER_SIZE_MODE_STACK
+                || start + len != active + 2 || (active[1] != '0' && active[1] != '1')) {
+            parser->p = start;
+            ddb_splitter_desc_fail (parser, "a size mode");
+            goto error;
+        }
+        node->active_child = active[1] - '0';
     }
 
-    /* realize the widget if required */
-    if (gtk_widget_get_realized (GTK_WIDGET (container)))
-        gtk_widget_realize (widget);
+    if (!ddb_splitter_desc_expect (parser, ',')) {
+        goto error;
+    }
+    ddb_splitter_desc_skip_ws (parser);
+    start = parser->p;
+    gchar *end;
+    gdouble proportion = g_ascii_strtod (start, &end);
+    if (end == start || proportion > 1.0) {
+        ddb_splitter_desc_fail (parser, "a proportion");
+        goto error;
+    }
+    node->proportion = proportion;
+    parser->p = end;
+
+    if (!ddb_splitter_desc_expect (parser, ',')
+            || !ddb_splitter_desc_uint (parser, &node->child1_size)
+            || !ddb_splitter_desc_expect (parser, ',')
+            || !ddb_splitter_desc_uint (parser, &node->child2_size)
+            || !ddb_splitter_desc_expect (parser, ',')) {
+        goto error;
+    }
 
-    /* map the widget if required */
-    if (gtk_widget_get_visible (GTK_WIDGET (container)) && gtk_widget_get_visible (widget))
-    {
-        if (gtk_widget_get_mapped (GTK_WIDGET (container)))
-            gtk_widget_map (widget);
+    node->children[0] = ddb_splitter_desc_parse_node (parser);
+    if (!node->children[0] || !ddb_splitter_desc_expect (parser, ',')) {
+        goto error;
+    }
+    node->children[1] = ddb_splitter_desc_parse_node (parser);
+    if (!node->children[1] || !ddb_splitter_desc_expect (parser, ')')) {
+        goto error;
     }
+    return node;
 
-    gtk_widget_queue_resize (GTK_WIDGET (container));
-    return;
+error:
+    ddb_splitter_desc_node_free (node);
+    return NULL;
 }
 
-static void
-ddb_splitter_remove (GtkContainer *container, GtkWidget *widget)
+/* Resolves all slot identifiers of @node and records the widgets in @needed */
+static gboolean
+ddb_splitter_desc_resolve (DdbSplitterDescNode *node,
+                           DdbSplitterSlotLookupFunc lookup_func,
+                           gpointer user_data,
+                           GHashTable *needed,
+                           GError **error)
 {
-    DdbSplitter *splitter = DDB_SPLITTER (container);
-
-    /* check if the widget was visible */
-    gboolean widget_was_visible = gtk_widget_get_visible (widget);
-
-    /* unparent and remove the widget */
-    gtk_widget_unparent (widget);
-    if (splitter->priv->child1 == widget) {
-        splitter->priv->child1 = NULL;
+    if (node->is_splitter) {
+        return ddb_splitter_desc_resolve (node->children[0], lookup_func, user_data, needed, error)
+            && ddb_splitter_desc_resolve (node->children[1], lookup_func, user_data, needed, error);
     }
-    else if (splitter->priv->child2 == widget) {
-        splitter->priv->child2 = NULL;
+    if (!node->slot_id || !lookup_func) {
+        return TRUE;
     }
 
-    if (G_LIKELY (widget_was_visible))
-        gtk_widget_queue_resize (GTK_WIDGET (splitter));
+    GtkWidget *widget = lookup_func (node->slot_id, user_data);
+    if (!widget) {
+        return TRUE;
+    }
+    if (g_hash_table_lookup (needed, widget)) {
+        g_set_error (error, DDB_SPLITTER_ERROR, DDB_SPLITTER_ERROR_DUPLICATE_SLOT,
+                "Slot \"%s\" is used more than once in the layout description",
+                node->slot_id);
+        return FALSE;
+    }
+    /* keep the widget alive while the tree is rearranged */
+    node->widget = g_object_ref (widget);
+    g_hash_table_insert (needed, widget, widget);
+    return TRUE;
 }
 
-static void
-ddb_splitter_forall (GtkContainer *container,
-                     gboolean include_internals,
-                     GtkCallback callback,
-                     gpointer callback_data)
+static DdbSplitterDescNode *
+ddb_splitter_desc_parse (const gchar *description,
+                         DdbSplitterSlotLookupFunc lookup_func,
+                         gpointer user_data,
+                         GHashTable *needed,
+                         GError **error)
 {
-    DdbSplitter *splitter = DDB_SPLITTER (container);
-    GtkWidget *c1 = splitter->priv->child1;
-    GtkWidget *c2 = splitter->priv->child2;
+    DdbSplitterDescParser parser = { description, description, error };
 
-    if (c1 && GTK_IS_WIDGET (c1)) {
-        (*callback) (c1, callback_data);
+    DdbSplitterDescNode *node = ddb_splitter_desc_parse_node (&parser);
+    if (!node) {
+        return NULL;
     }
-    if (c2 && GTK_IS_WIDGET (c2)) {
-        (*callback) (c2, callback_data);
+    ddb_splitter_desc_skip_ws (&parser);
+    if (!node->is_splitter) {
+        parser.p = description;
+        ddb_splitter_desc_fail (&parser, "'('");
+        ddb_splitter_desc_node_free (node);
+        return NULL;
+    }
+    if (*parser.p) {
+        ddb_splitter_desc_fail (&parser, "end of description");
+        ddb_splitter_desc_node_free (node);
+        return NULL;
+    }
+    if (!ddb_splitter_desc_resolve (node, lookup_func, user_data, needed, error)) {
+        ddb_splitter_desc_node_free (node);
+        return NULL;
     }
+    return node;
 }
 
+/* Detaches the widgets in @needed from the subtree @widget is about to be
+ * discarded with, so they survive its destruction */
 static void
-ddb_splitter_remove_child (DdbSplitter *splitter, guint child)
+ddb_splitter_desc_harvest (GtkWidget *widget, GHashTable *needed)
 {
-    if (child == 1 && splitter->priv->child1) {
-        ddb_splitter_remove (GTK_CONTAINER (splitter), splitter->priv->child1);
+    if (!DDB_IS_SPLITTER (widget)) {
+        return;
     }
-    else if (child == 2 && splitter->priv->child2) {
-        ddb_splitter_remove (GTK_CONTAINER (splitter), splitter->priv->child2);
+
+    DdbSplitter *splitter = DDB_SPLITTER (widget);
+    GtkWidget *children[2] = { splitter->priv->child1, splitter->priv->child2 };
+
+    for (guint i = 0; i < 2; i++) {
+        if (!children[i]) {
+            continue;
+        }
+        if (g_hash_table_lookup (needed, children[i])) {
+            ddb_splitter_detach_child (splitter, children[i]);
+        }
+        else {
+            ddb_splitter_desc_harvest (children[i], needed);
+        }
     }
 }
 
-void
-ddb_splitter_remove_c1 (DdbSplitter *splitter)
+static void
+ddb_splitter_desc_apply_node (DdbSplitter *splitter,
+                              DdbSplitterDescNode *node,
+                              GHashTable *needed)
 {
-    ddb_splitter_remove_child (splitter, 1);
-}
+    DdbSplitterPrivate *priv = splitter->priv;
+    gboolean changed = FALSE;
 
-void
-ddb_splitter_remove_c2 (DdbSplitter *splitter)
-{
-    ddb_splitter_remove_child (splitter, 2);
-}
+    g_object_freeze_notify (G_OBJECT (splitter));
 
-gboolean
-ddb_splitter_add_child_at_pos (DdbSplitter *splitter, GtkWidget *child, guint pos)
-{
-    if (pos == 0 && !splitter->priv->child1) {
-        splitter->priv->child1 = child;
+    if (priv->orientation != node->orientation) {
+        priv->orientation = node->orientation;
+        ddb_splitter_update_cursor (splitter);
+        g_object_notify (G_OBJECT (splitter), "orientation");
+        changed = TRUE;
     }
-    else if (pos == 1 && !splitter->priv->child2) {
-        splitter->priv->child2 = child;
+    if (priv->size_mode != node->size_mode) {
+        if (priv->size_mode == DDB_SPLITTER_SIZE_MODE_STACK) {
+            ddb_splitter_leave_stack (splitter);
+        }
+        priv->size_mode = node->size_mode;
+        ddb_splitter_update_cursor (splitter);
+        g_object_notify (G_OBJECT (splitter), "size_mode");
+        changed = TRUE;
     }
-    else {
-        return FALSE;
+    if (priv->active_child != node->active_child) {
+        priv->active_child = node->active_child;
+        if (priv->unrealize_id) {
+            g_source_remove (priv->unrealize_id);
+            priv->unrealize_id = 0;
+        }
+        g_object_notify (G_OBJECT (splitter), "active-child");
+        changed = changed || priv->size_mode == DDB_SPLITTER_SIZE_MODE_STACK;
+    }
+    if (priv->proportion != node->proportion) {
+        priv->proportion = node->proportion;
+        g_object_notify (G_OBJECT (splitter), "proportion");
+        changed = TRUE;
+    }
+    if (priv->child1_size != node->child1_size || priv->child2_size != node->child2_size) {
+        priv->child1_size = node->child1_size;
+        priv->child2_size = node->child2_size;
+        g_object_notify (G_OBJECT (splitter), "locked-size");
+        changed = TRUE;
     }
 
-    gtk_widget_set_parent (child, GTK_WIDGET (splitter));
-    /* realize the widget if required */
-    if (gtk_widget_get_realized (GTK_WIDGET (splitter)))
-        gtk_widget_realize (child);
+    for (guint pos = 0; pos < 2; pos++) {
+        DdbSplitterDescNode *child = node->children[pos];
+        GtkWidget *current = pos == 0 ? priv->child1 : priv->child2;
 
-    /* map the widget if required */
-    if (gtk_widget_get_visible (GTK_WIDGET (splitter)) && gtk_widget_get_visible (child))
-    {
-        if (gtk_widget_get_mapped (GTK_WIDGET (splitter)))
-            gtk_widget_map (child);
+        if (child->is_splitter && current && DDB_IS_SPLITTER (current)
+                && !g_hash_table_lookup (needed, current)) {
+            /* reuse the nested splitter, it only changes what differs */
+            ddb_splitter_desc_apply_node (DDB_SPLITTER (current), child, needed);
+            continue;
+        }
+        if (!child->is_splitter && current && current == child->widget) {
+            continue;
+        }
+
+        if (current) {
+            if (!g_hash_table_lookup (needed, current)) {
+                ddb_splitter_desc_harvest (current, needed);
+            }
+            ddb_splitter_detach_child (splitter, current);
+        }
+        changed = TRUE;
+
+        GtkWidget *widget = child->widget;
+        if (child->is_splitter) {
+            widget = ddb_splitter_new (child->orientation);
+            ddb_splitter_desc_apply_node (DDB_SPLITTER (widget), child, needed);
+            gtk_widget_show (widget);
+        }
+        if (!widget) {
+            continue;
+        }
+
+        GtkWidget *parent = gtk_widget_get_parent (widget);
+        if (parent) {
+            /* still attached somewhere else in the tree */
+            if (DDB_IS_SPLITTER (parent)) {
+                ddb_splitter_detach_child (DDB_SPLITTER (parent), widget);
+                ddb_splitter_queue_resize (DDB_SPLITTER (parent), DDB_SPLITTER_RESIZE_CAUSE_CHILDREN);
+            }
+            else {
+                gtk_container_remove (GTK_CONTAINER (parent), widget);
+            }
+        }
+        ddb_splitter_attach_child (splitter, widget, pos);
     }
 
-    gtk_widget_queue_resize (GTK_WIDGET (splitter));
-    return TRUE;
-}
+    if (changed) {
+        ddb_splitter_queue_resize (splitter, DDB_SPLITTER_RESIZE_CAUSE_LAYOUT);
+    }
 
-/**
- * ddb_splitter_get_size_mode:
- * @splitter : a #DdbSplitter.
- *
- * Returns the size mode of the splitter
- *
- * Returns: the size mode of @splitter.
- **/
-DdbSplitterSizeMode
-ddb_splitter_get_size_mode (const DdbSplitter *splitter)
-{
-    g_return_val_if_fail (DDB_IS_SPLITTER (splitter), DDB_SPLITTER_SIZE_MODE_PROP);
-    return splitter->priv->size_mode;
+    g_object_thaw_notify (G_OBJECT (splitter));
 }
 
-/**
- * ddb_splitter_set_size_mode:
- * @splitter    : a #DdbSplitter.
- * @size_mode : The size_mode of the splitter.
- *
- * Sets the size_mode of the @splitter
- **/
-void
-ddb_splitter_set_size_mode (DdbSplitter *splitter, DdbSplitterSizeMode size_mode)
+static void
+ddb_splitter_serialize_node (GtkWidget *widget,
+                             GString *str,
+                             DdbSplitterSlotNameFunc name_func,
+                             gpointer user_data)
 {
-    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+    if (!widget) {
+        g_string_append_c (str, '-');
+        return;
+    }
 
-    if (G_LIKELY (splitter->priv->size_mode != size_mode))
-    {
-        splitter->priv->size_mode = size_mode;
-        ddb_splitter_update_cursor (splitter);
-        gtk_widget_queue_resize (GTK_WIDGET (splitter));
-        g_object_notify (G_OBJECT (splitter), "size_mode");
+    if (!DDB_IS_SPLITTER (widget)) {
+        const gchar *name = name_func ? name_func (widget, user_data) : gtk_widget_get_name (widget);
+        const gchar *c;
+
+        for (c = name; c && *c && ddb_splitter_desc_is_slot_char (*c); c++);
+        if (!name || !*name || *c || strcmp (name, "-") == 0) {
+            g_warning ("DdbSplitter: can't serialize slot name \"%s\"", name ? name : "(null)");
+            g_string_append_c (str, '-');
+        }
+        else {
+            g_string_append (str, name);
+        }
+        return;
     }
+
+    DdbSplitter *splitter = DDB_SPLITTER (widget);
+    gchar proportion[G_ASCII_DTOSTR_BUF_SIZE];
+
+    /* enough digits to read back the very same float */
+    g_ascii_formatd (proportion, sizeof (proportion), "%.9g", splitter->priv->proportion);
+    g_string_append_printf (str, "(%c,%s%s,%s,%u,%u,",
+            splitter->priv->orientation == GTK_ORIENTATION_HORIZONTAL ? 'h' : 'v',
+            ddb_splitter_size_mode_to_token (splitter->priv->size_mode),
+            splitter->priv->size_mode != DDB_SPLITTER_SIZE_MODE_STACK ? ""
+                : splitter->priv->active_child ? ":1" : ":0",
+            proportion,
+            splitter->priv->child1_size,
+            splitter->priv->child2_size);
+    ddb_splitter_serialize_node (splitter->priv->child1, str, name_func, user_data);
+    g_string_append_c (str, ',');
+    ddb_splitter_serialize_node (splitter->priv->child2, str, name_func, user_data);
+    g_string_append_c (str, ')');
 }
 
 /**
- * ddb_splitter_get_orientation:
- * @splitter : a #DdbSplitter.
+ * ddb_splitter_serialize:
+ * @splitter  : a #DdbSplitter.
+ * @name_func : (allow-none): returns the slot identifier of a child
+ *              which isn't a #DdbSplitter, or %NULL to use the widget name.
+ * @user_data : data passed to @name_func.
  *
- * Returns the orientation of the splitter
+ * Serializes the tree of splitters rooted at @splitter: orientation, size
+ * mode, active child in stack mode, proportion, locked sizes and slot
+ * identifiers of the children.
  *
- * Returns: the orientation of @splitter.
+ * Returns: a newly allocated layout description, free with g_free().
  **/
-GtkOrientation
-ddb_splitter_get_orientation (const DdbSplitter *splitter)
+gchar *
+ddb_splitter_serialize (DdbSplitter *splitter,
+                        DdbSplitterSlotNameFunc name_func,
+                        gpointer user_data)
 {
-    g_return_val_if_fail (DDB_IS_SPLITTER (splitter), GTK_ORIENTATION_HORIZONTAL);
-    return splitter->priv->orientation;
+    g_return_val_if_fail (DDB_IS_SPLITTER (splitter), NULL);
+
+    GString *str = g_string_new (NULL);
+    ddb_splitter_serialize_node (GTK_WIDGET (splitter), str, name_func, user_data);
+    return g_string_free (str, FALSE);
 }
 
 /**
- * ddb_splitter_set_orientation:
+ * ddb_splitter_apply_description:
  * @splitter    : a #DdbSplitter.
- * @orientation : The orientation of the splitter.
+ * @description : a layout description as returned by ddb_splitter_serialize().
+ * @lookup_func : (allow-none): returns the widget for a slot identifier.
+ * @user_data   : data passed to @lookup_func.
+ * @error       : return location for a #GError, or %NULL.
  *
- * Sets the orientation of the @splitter
+ * Changes the tree rooted at @splitter to match @description. Only the
+ * splitters which differ from the description are changed and resized;
+ * nested splitters and children which are already in place are reused.
+ * Slots whose identifier can't be resolved are left empty. Children which
+ * no longer appear in the layout are removed from it.
+ *
+ * Returns: %TRUE on success, %FALSE if @description is invalid, in which
+ * case @splitter is left untouched.
  **/
-void
-ddb_splitter_set_orientation (DdbSplitter *splitter, GtkOrientation orientation)
+gboolean
+ddb_splitter_apply_description (DdbSplitter *splitter,
+                                const gchar *description,
+                                DdbSplitterSlotLookupFunc lookup_func,
+                                gpointer user_data,
+                                GError **error)
 {
-    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+    g_return_val_if_fail (DDB_IS_SPLITTER (splitter), FALSE);
+    g_return_val_if_fail (description != NULL, FALSE);
 
-    if (G_LIKELY (splitter->priv->orientation != orientation))
-    {
-        splitter->priv->orientation = orientation;
-        gtk_widget_queue_resize (GTK_WIDGET (splitter));
-        g_object_notify (G_OBJECT (splitter), "orientation");
+    GHashTable *needed = g_hash_table_new (g_direct_hash, g_direct_equal);
+    DdbSplitterDescNode *node = ddb_splitter_desc_parse (description, lookup_func, user_data, needed, error);
+
+    if (node) {
+        ddb_splitter_desc_apply_node (splitter, node, needed);
+        ddb_splitter_desc_node_free (node);
     }
+
+    g_hash_table_destroy (needed);
+    return node != NULL;
 }
 
 /**
- * ddb_splitter_get_proportion:
- * @splitter : a #DdbSplitter.
+ * ddb_splitter_new_from_description:
+ * @description : a layout description as returned by ddb_splitter_serialize().
+ * @lookup_func : (allow-none): returns the widget for a slot identifier.
+ * @user_data   : data passed to @lookup_func.
+ * @error       : return location for a #GError, or %NULL.
  *
- * Returns the proportion of the splitter
+ * Builds a whole tree of splitters in one batch, without resizing
+ * for every child that is added.
  *
- * Returns: the proportion of the @splitter.
+ * Returns: the root #DdbSplitter, or %NULL if @description is invalid.
  **/
-gfloat
-ddb_splitter_get_proportion (const DdbSplitter *splitter)
+GtkWidget *
+ddb_splitter_new_from_description (const gchar *description,
+                                   DdbSplitterSlotLookupFunc lookup_func,
+                                   gpointer user_data,
+                                   GError **error)
 {
-    g_return_val_if_fail (DDB_IS_SPLITTER (splitter), 0.f);
-    return splitter->priv->proportion;
-}
+    g_return_val_if_fail (description != NULL, NULL);
 
-/**
- * ddb_splitter_set_proportion:
- * @splitter    : a #DdbSplitter.
- * @proportion : The proportion how the child should be arranged.
- *
- * Sets the proportion of the @splitter
- **/
-void
-ddb_splitter_set_proportion (DdbSplitter *splitter, gfloat proportion)
-{
-    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+    GHashTable *needed = g_hash_table_new (g_direct_hash, g_direct_equal);
+    DdbSplitterDescNode *node = ddb_splitter_desc_parse (description, lookup_func, user_data, needed, error);
+    GtkWidget *splitter = NULL;
 
-    if (splitter->priv->size_mode == DDB_SPLITTER_SIZE_MODE_PROP
-           && G_LIKELY (splitter->priv->proportion != proportion))
-    {
-        splitter->priv->proportion = proportion;
-        gtk_widget_queue_resize (GTK_WIDGET (splitter));
-        g_object_notify (G_OBJECT (splitter), "proportion");
+    if (node) {
+        splitter = ddb_splitter_new (node->orientation);
+        ddb_splitter_desc_apply_node (DDB_SPLITTER (splitter), node, needed);
+        ddb_splitter_desc_node_free (node);
     }
+
+    g_hash_table_destroy (needed);
+    return splitter;
 }
 
 /* Return a new PSquare cast to a GtkWidget */
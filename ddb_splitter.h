@@ -28,6 +28,7 @@ G_BEGIN_DECLS
 typedef struct _DdbSplitterPrivate DdbSplitterPrivate;
 typedef struct _DdbSplitterClass   DdbSplitterClass;
 typedef struct _DdbSplitter        DdbSplitter;
+typedef struct _DdbSplitterSyncGroup DdbSplitterSyncGroup;
 
 #define DDB_TYPE_SPLITTER             (ddb_splitter_get_type ())
 #define DDB_SPLITTER(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), DDB_TYPE_SPLITTER, DdbSplitter))
@@ -36,6 +37,73 @@ typedef struct _DdbSplitter        DdbSplitter;
 #define DDB_IS_SPLITTER_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), DDB_TYPE_SPLITTER))
 #define DDB_SPLITTER_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), DDB_TYPE_SPLITTER, DdbSplitterClass))
 
+#define DDB_SPLITTER_ERROR            (ddb_splitter_error_quark ())
+
+typedef enum
+{
+    DDB_SPLITTER_ERROR_PARSE,
+    DDB_SPLITTER_ERROR_DUPLICATE_SLOT,
+    DDB_SPLITTER_ERROR_UNSUPPORTED,
+} DdbSplitterError;
+
+/* Easing curves of animated handle movements */
+typedef enum
+{
+    DDB_SPLITTER_EASING_LINEAR,
+    DDB_SPLITTER_EASING_EASE_IN_OUT,
+    DDB_SPLITTER_EASING_EASE_OUT,
+} DdbSplitterEasing;
+
+/* Reasons for a splitter to request a new size */
+typedef enum
+{
+    DDB_SPLITTER_RESIZE_CAUSE_PROPORTION,
+    DDB_SPLITTER_RESIZE_CAUSE_SIZE_MODE,
+    DDB_SPLITTER_RESIZE_CAUSE_ORIENTATION,
+    DDB_SPLITTER_RESIZE_CAUSE_CHILDREN,
+    DDB_SPLITTER_RESIZE_CAUSE_VISIBILITY,
+    DDB_SPLITTER_RESIZE_CAUSE_LAYOUT,
+    DDB_SPLITTER_N_RESIZE_CAUSES,
+} DdbSplitterResizeCause;
+
+/**
+ * DdbSplitterStats:
+ * @size_allocate_calls       : number of size allocations of the splitter.
+ * @child_allocations         : number of allocations handed to children.
+ * @child_allocations_skipped : number of child allocations that were
+ *                              deferred or not needed.
+ * @resizes                   : number of resizes queued, by #DdbSplitterResizeCause.
+ * @drag_motion_events        : number of motion events received while dragging.
+ * @drag_motion_applied       : number of motion events that moved the handle.
+ * @allocate_time             : time spent allocating, without the children, in µs.
+ * @child_allocate_time       : time spent in the allocation of children, in µs.
+ * @paint_time                : time spent painting the handle, in µs.
+ * @thrash_detections         : number of times the layout was found thrashing,
+ *                              see ddb_splitter_set_thrash_detection().
+ * @child_moves_copied        : number of children that only moved and were
+ *                              copied instead of repainted.
+ *
+ * Performance counters of a #DdbSplitter.
+ **/
+typedef struct
+{
+    guint64 size_allocate_calls;
+    guint64 child_allocations;
+    guint64 child_allocations_skipped;
+    guint64 resizes[DDB_SPLITTER_N_RESIZE_CAUSES];
+    guint64 drag_motion_events;
+    guint64 drag_motion_applied;
+    gint64 allocate_time;
+    gint64 child_allocate_time;
+    gint64 paint_time;
+    guint64 thrash_detections;
+    guint64 child_moves_copied;
+} DdbSplitterStats;
+
+/* Maps slot identifiers of layout descriptions to widgets and back */
+typedef GtkWidget   *(*DdbSplitterSlotLookupFunc) (const gchar *slot_id, gpointer user_data);
+typedef const gchar *(*DdbSplitterSlotNameFunc)   (GtkWidget *child, gpointer user_data);
+
 struct _DdbSplitterClass
 {
   /*< private >*/
@@ -64,8 +132,16 @@ struct _DdbSplitter
 GType
 ddb_splitter_get_type (void) G_GNUC_CONST;
 
+GQuark
+ddb_splitter_error_quark (void);
+
 GtkWidget
 *ddb_splitter_new (GtkOrientation orientation);
+GtkWidget
+*ddb_splitter_new_from_description (const gchar *description,
+                                    DdbSplitterSlotLookupFunc lookup_func,
+                                    gpointer user_data,
+                                    GError **error);
 
 DdbSplitterSizeMode
 ddb_splitter_get_size_mode (const DdbSplitter *splitter);
@@ -82,7 +158,87 @@ ddb_splitter_remove_c1 (DdbSplitter *splitter);
 void
 ddb_splitter_remove_c2 (DdbSplitter *splitter);
 void
+ddb_splitter_swap_children (DdbSplitter *splitter);
+gboolean
+ddb_splitter_move_child (DdbSplitter *splitter, guint pos, DdbSplitter *dest, guint dest_pos);
+void
 ddb_splitter_set_proportion (DdbSplitter *splitter, gfloat proportion);
+gint
+ddb_splitter_get_locked_size (const DdbSplitter *splitter);
+void
+ddb_splitter_set_locked_size (DdbSplitter *splitter, gint locked_size);
+void
+ddb_splitter_set_child_size_pending (DdbSplitter *splitter, GtkWidget *child, gint width, gint height);
+void
+ddb_splitter_child_size_hint_ready (DdbSplitter *splitter, GtkWidget *child, gint width, gint height);
+void
+ddb_splitter_clear_child_size_hint (DdbSplitter *splitter, GtkWidget *child);
+void
+ddb_splitter_post_proportion (DdbSplitter *splitter, gfloat proportion);
+void
+ddb_splitter_post_size_mode (DdbSplitter *splitter, DdbSplitterSizeMode size_mode);
+void
+ddb_splitter_post_locked_size (DdbSplitter *splitter, gint locked_size);
+void
+ddb_splitter_animate_proportion (DdbSplitter *splitter,
+                                 gfloat proportion,
+                                 guint duration,
+                                 DdbSplitterEasing easing);
+void
+ddb_splitter_animate_locked_size (DdbSplitter *splitter,
+                                  gint locked_size,
+                                  guint duration,
+                                  DdbSplitterEasing easing);
+void
+ddb_splitter_stop_animation (DdbSplitter *splitter);
+guint
+ddb_splitter_get_active_child (const DdbSplitter *splitter);
+void
+ddb_splitter_set_active_child (DdbSplitter *splitter, guint pos);
+gint
+ddb_splitter_get_unrealize_timeout (const DdbSplitter *splitter);
+void
+ddb_splitter_set_unrealize_timeout (DdbSplitter *splitter, gint timeout);
+gboolean
+ddb_splitter_get_heatmap (const DdbSplitter *splitter);
+void
+ddb_splitter_set_heatmap (DdbSplitter *splitter, gboolean heatmap);
+gboolean
+ddb_splitter_get_virtualize (const DdbSplitter *splitter);
+void
+ddb_splitter_set_virtualize (DdbSplitter *splitter, gboolean virtualize);
+gboolean
+ddb_splitter_get_copy_on_move (const DdbSplitter *splitter);
+void
+ddb_splitter_set_copy_on_move (DdbSplitter *splitter, gboolean copy_on_move);
+guint
+ddb_splitter_get_defer_interval (const DdbSplitter *splitter);
+void
+ddb_splitter_set_defer_interval (DdbSplitter *splitter, guint interval);
+void
+ddb_splitter_get_stats (const DdbSplitter *splitter, DdbSplitterStats *stats);
+void
+ddb_splitter_reset_stats (DdbSplitter *splitter);
+void
+ddb_splitter_get_subtree_stats (GtkWidget *widget, DdbSplitterStats *stats);
+void
+ddb_splitter_reset_subtree_stats (GtkWidget *widget);
+void
+ddb_splitter_set_thrash_detection (guint max_allocations, gboolean break_on_detection);
+DdbSplitterSyncGroup *
+ddb_splitter_get_sync_group (const DdbSplitter *splitter);
+void
+ddb_splitter_set_sync_group (DdbSplitter *splitter, DdbSplitterSyncGroup *group);
+gchar *
+ddb_splitter_serialize (DdbSplitter *splitter,
+                        DdbSplitterSlotNameFunc name_func,
+                        gpointer user_data);
+gboolean
+ddb_splitter_apply_description (DdbSplitter *splitter,
+                                const gchar *description,
+                                DdbSplitterSlotLookupFunc lookup_func,
+                                gpointer user_data,
+                                GError **error);
 
 G_END_DECLS
 
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2016 Christian Boxdörfer <christian.boxdoerfer@posteo.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include "ddb_splitter_layout.h"
+
+/* Positions and sizes along the split are called main, across it cross */
+static void
+ddb_splitter_layout_set_rect (DdbSplitterRect *rect, int vertical, int main_pos, int cross_pos, int main_size, int cross_size)
+{
+    if (vertical) {
+        rect->x = cross_pos;
+        rect->y = main_pos;
+        rect->width = cross_size;
+        rect->height = main_size;
+    }
+    else {
+        rect->x = main_pos;
+        rect->y = cross_pos;
+        rect->width = main_size;
+        rect->height = cross_size;
+    }
+}
+
+/* Limits of the child in slot @i within @space */
+static void
+ddb_splitter_layout_limits (const DdbSplitterLayoutInput *input, int i, int space, int *lo, int *hi)
+{
+    int min = 1;
+    int max = space;
+
+    if (input->min_size[i] > min) {
+        min = input->min_size[i];
+    }
+    if (input->min_fraction[i] > 0.0f && (int)(input->min_fraction[i] * space + 0.5f) > min) {
+        min = (int)(input->min_fraction[i] * space + 0.5f);
+    }
+    if (input->max_size[i] >= 0 && input->max_size[i] < max) {
+        max = input->max_size[i];
+    }
+    if (input->max_fraction[i] >= 0.0f && (int)(input->max_fraction[i] * space + 0.5f) < max) {
+        max = (int)(input->max_fraction[i] * space + 0.5f);
+    }
+
+    /* a minimum beats a maximum */
+    *lo = min;
+    *hi = max > min ? max : min;
+}
+
+/**
+ * ddb_splitter_layout_clamp:
+ * @input       : the state of the splitter.
+ * @child1_size : a size of the first child along the split.
+ *
+ * Limits @child1_size so that both children keep within their minimum
+ * and maximum sizes, see #DdbSplitterLayoutInput. When the limits can't
+ * all be met, the minimums win, the one of the first child first.
+ *
+ * Returns: the limited size of the first child.
+ **/
+int
+ddb_splitter_layout_clamp (const DdbSplitterLayoutInput *input, int child1_size)
+{
+    const int main_size = input->vertical ? input->area.height : input->area.width;
+    const int space = main_size - input->handle_size;
+    int lo1, hi1, lo2, hi2;
+
+    if (space <= 0) {
+        return child1_size;
+    }
+
+    ddb_splitter_layout_limits (input, 0, space, &lo1, &hi1);
+    ddb_splitter_layout_limits (input, 1, space, &lo2, &hi2);
+
+    int lower = lo1 > space - hi2 ? lo1 : space - hi2;
+    int upper = hi1 < space - lo2 ? hi1 : space - lo2;
+    if (lower > upper) {
+        lower = lo1;
+        upper = space - lo2;
+    }
+
+    if (child1_size > upper) {
+        child1_size = upper;
+    }
+    if (child1_size < lower) {
+        child1_size = lower;
+    }
+    return child1_size;
+}
+
+/**
+ * ddb_splitter_layout_compute:
+ * @input  : the state of the splitter.
+ * @result : return location for the layout.
+ *
+ * Computes where the children and the handle of a splitter go.
+ **/
+void
+ddb_splitter_layout_compute (const DdbSplitterLayoutInput *input, DdbSplitterLayoutResult *result)
+{
+    const int vertical = input->vertical;
+    const int main_pos = vertical ? input->area.y : input->area.x;
+    const int cross_pos = vertical ? input->area.x : input->area.y;
+    const int main_size = vertical ? input->area.height : input->area.width;
+    const int cross_size = vertical ? input->area.width : input->area.height;
+    const int visible1 = input->visible[0] != 0;
+    const int visible2 = input->visible[1] != 0;
+    const int num_visible = visible1 + visible2;
+    const int handle_size = num_visible > 1 && input->mode != DDB_SPLITTER_LAYOUT_STACK ? input->handle_size : 0;
+    const int cross = cross_size > 1 ? cross_size : 1;
+
+    result->visible[0] = visible1;
+    result->visible[1] = visible2;
+    result->handle_size = handle_size;
+    result->child1_size = input->child1_size;
+    result->child2_size = input->child2_size;
+    result->proportion = input->proportion;
+    result->handle = input->area;
+    result->handle.width = 0;
+    result->handle.height = 0;
+
+    if (input->mode == DDB_SPLITTER_LAYOUT_STACK) {
+        const int active = input->active_child ? 1 : 0;
+        result->visible[1 - active] = 0;
+        result->child[active] = input->area;
+        return;
+    }
+
+    int child1_end = main_pos;
+    int constrained = 0;
+    if (visible1) {
+        int size;
+        if (input->mode == DDB_SPLITTER_LAYOUT_LOCK_C1) {
+            // child 1 locked, use saved size
+            size = input->child1_size;
+        }
+        else if (num_visible == 1) {
+            // only one child, use all space
+            size = main_size;
+        }
+        else if (input->mode == DDB_SPLITTER_LAYOUT_LOCK_C2) {
+            // two children and second one is locked, use all space left
+            size = main_size - input->child2_size - handle_size;
+        }
+        else {
+            // two children visible and proportional scaling is active
+            size = (main_size - handle_size) * input->proportion;
+        }
+        if (num_visible > 1) {
+            int limited = ddb_splitter_layout_clamp (input, size);
+            constrained = limited != size;
+            size = limited;
+        }
+        if (size < 1) {
+            size = 1;
+        }
+
+        ddb_splitter_layout_set_rect (&result->child[0], vertical, main_pos, cross_pos, size, cross);
+        ddb_splitter_layout_set_rect (&result->handle, vertical, main_pos + size, cross_pos, handle_size, cross);
+        if (!constrained || input->mode != DDB_SPLITTER_LAYOUT_LOCK_C1) {
+            result->child1_size = size;
+        }
+        if (input->mode != DDB_SPLITTER_LAYOUT_PROP && main_size - handle_size > 0) {
+            float proportion = (float)size / (main_size - handle_size);
+            result->proportion = proportion < 0.0f ? 0.0f : proportion > 1.0f ? 1.0f : proportion;
+        }
+        child1_end = main_pos + size;
+    }
+
+    if (visible2) {
+        int size;
+        if (input->mode == DDB_SPLITTER_LAYOUT_LOCK_C2 && !constrained) {
+            // child 2 locked, use saved size
+            size = input->child2_size;
+        }
+        else if (num_visible == 1) {
+            // only one child, use all space
+            size = main_size;
+        }
+        else {
+            // the first child is locked or proportional, use all space left
+            size = main_size - (child1_end - main_pos) - handle_size;
+        }
+        if (size < 1) {
+            size = 1;
+        }
+
+        ddb_splitter_layout_set_rect (&result->child[1], vertical, child1_end + handle_size, cross_pos, size, cross);
+        if (!constrained || input->mode != DDB_SPLITTER_LAYOUT_LOCK_C2) {
+            result->child2_size = size;
+        }
+    }
+}
+
+/**
+ * ddb_splitter_layout_compute_many:
+ * @inputs  : the states of @count splitters.
+ * @results : return location for @count layouts.
+ * @count   : the number of splitters.
+ *
+ * Computes the layouts of many splitters at once.
+ **/
+void
+ddb_splitter_layout_compute_many (const DdbSplitterLayoutInput *inputs, DdbSplitterLayoutResult *results, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        ddb_splitter_layout_compute (&inputs[i], &results[i]);
+    }
+}
+
+/**
+ * ddb_splitter_layout_compute_sizes:
+ * @input   : the state of the splitter.
+ * @widths  : @count widths of the splitter.
+ * @heights : @count heights of the splitter.
+ * @results : return location for @count layouts.
+ * @count   : the number of sizes.
+ *
+ * Computes the layouts of one splitter for many sizes, e.g. all sizes it
+ * goes through while a window is resized.
+ **/
+void
+ddb_splitter_layout_compute_sizes (const DdbSplitterLayoutInput *input,
+                                   const int *widths,
+                                   const int *heights,
+                                   DdbSplitterLayoutResult *results,
+                                   size_t count)
+{
+    DdbSplitterLayoutInput sized = *input;
+
+    for (size_t i = 0; i < count; i++) {
+        sized.area.width = widths[i];
+        sized.area.height = heights[i];
+        ddb_splitter_layout_compute (&sized, &results[i]);
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2016 Christian Boxdörfer <christian.boxdoerfer@posteo.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef __DDB_SPLITTER_LAYOUT_H__
+#define __DDB_SPLITTER_LAYOUT_H__
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The geometry rules of DdbSplitter in plain C, without GTK or GLib, so
+ * they can be benchmarked and tested without a display. */
+
+/* Same values as DdbSplitterSizeMode */
+typedef enum
+{
+    DDB_SPLITTER_LAYOUT_PROP,
+    DDB_SPLITTER_LAYOUT_LOCK_C1,
+    DDB_SPLITTER_LAYOUT_LOCK_C2,
+    DDB_SPLITTER_LAYOUT_STACK,
+} DdbSplitterLayoutMode;
+
+typedef struct
+{
+    int x;
+    int y;
+    int width;
+    int height;
+} DdbSplitterRect;
+
+typedef struct
+{
+    /* the area to split */
+    DdbSplitterRect area;
+    /* 0 for side by side, 1 for on top of each other */
+    int vertical;
+    DdbSplitterLayoutMode mode;
+    float proportion;
+    /* locked sizes of the children */
+    int child1_size;
+    int child2_size;
+    int handle_size;
+    int visible[2];
+    /* the child shown in DDB_SPLITTER_LAYOUT_STACK mode */
+    int active_child;
+    /* limits of the child sizes along the split when both children are
+     * shown, in pixels and as fractions of the space next to the handle.
+     * Negative maximums mean no limit */
+    int min_size[2];
+    int max_size[2];
+    float min_fraction[2];
+    float max_fraction[2];
+} DdbSplitterLayoutInput;
+
+typedef struct
+{
+    /* whether the child gets a rectangle */
+    int visible[2];
+    DdbSplitterRect child[2];
+    DdbSplitterRect handle;
+    /* the handle size in effect, 0 if there's no handle */
+    int handle_size;
+    /* the resulting sizes of the children along the split, and the
+     * resulting proportion. A locked size that had to be limited is
+     * passed through unchanged, so it comes back when there's room */
+    int child1_size;
+    int child2_size;
+    float proportion;
+} DdbSplitterLayoutResult;
+
+void
+ddb_splitter_layout_compute (const DdbSplitterLayoutInput *input, DdbSplitterLayoutResult *result);
+
+int
+ddb_splitter_layout_clamp (const DdbSplitterLayoutInput *input, int child1_size);
+
+void
+ddb_splitter_layout_compute_many (const DdbSplitterLayoutInput *inputs, DdbSplitterLayoutResult *results, size_t count);
+
+void
+ddb_splitter_layout_compute_sizes (const DdbSplitterLayoutInput *input,
+                                   const int *widths,
+                                   const int *heights,
+                                   DdbSplitterLayoutResult *results,
+                                   size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* !__DDB_SPLITTER_LAYOUT_H__ */
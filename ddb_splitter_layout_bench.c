@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2016 Christian Boxdörfer <christian.boxdoerfer@posteo.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+/* Measures how many layouts the GTK-independent layout core computes per
+ * second, and checks a few invariants on the way. Needs no display. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "ddb_splitter_layout.h"
+
+#define NUM_SIZES 4096
+#define NUM_ROUNDS 500
+
+static double
+now (void)
+{
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Both visible children and the handle have to tile the area */
+static int
+check (const DdbSplitterLayoutInput *input, const DdbSplitterLayoutResult *result)
+{
+    if (input->mode == DDB_SPLITTER_LAYOUT_STACK || !result->visible[0] || !result->visible[1]) {
+        return 1;
+    }
+    const int vertical = input->vertical;
+    const int main_size = vertical ? input->area.height : input->area.width;
+    const int size1 = vertical ? result->child[0].height : result->child[0].width;
+    const int size2 = vertical ? result->child[1].height : result->child[1].width;
+
+    if (size1 < 1 || size2 < 1) {
+        return 0;
+    }
+    /* children only overflow the area when it is too small for them */
+    if (size1 + result->handle_size + size2 != main_size && size1 > 1 && size2 > 1) {
+        return 0;
+    }
+    /* the limits hold whenever there's room for them */
+    const int space = main_size - result->handle_size;
+    if (space >= input->min_size[0] * 2) {
+        if (size1 < input->min_size[0]) {
+            return 0;
+        }
+        if (input->max_fraction[1] >= 0.0f && size2 > (int)(input->max_fraction[1] * space + 0.5f)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int
+main (int argc, char *argv[])
+{
+    static int widths[NUM_SIZES];
+    static int heights[NUM_SIZES];
+    static DdbSplitterLayoutResult results[NUM_SIZES];
+    static const char *mode_names[] = { "prop", "lock1", "lock2", "stack" };
+    int rounds = argc > 1 ? atoi (argv[1]) : NUM_ROUNDS;
+    int failed = 0;
+
+    for (int i = 0; i < NUM_SIZES; i++) {
+        widths[i] = 1 + i % 2000;
+        heights[i] = 1 + (i * 7) % 1200;
+    }
+
+    for (int mode = DDB_SPLITTER_LAYOUT_PROP; mode <= DDB_SPLITTER_LAYOUT_STACK; mode++) {
+        for (int variant = 0; variant < 4; variant++) {
+            const int vertical = variant & 1;
+            const int limited = variant >> 1;
+            DdbSplitterLayoutInput input = {
+                .area = { 0, 0, 0, 0 },
+                .vertical = vertical,
+                .mode = mode,
+                .proportion = 0.3f,
+                .child1_size = 200,
+                .child2_size = 150,
+                .handle_size = 5,
+                .visible = { 1, 1 },
+                .active_child = 0,
+                .min_size = { limited ? 120 : 0, 0 },
+                .max_size = { -1, -1 },
+                .min_fraction = { 0.0f, limited ? 0.1f : 0.0f },
+                .max_fraction = { -1.0f, limited ? 0.6f : -1.0f },
+            };
+
+            double start = now ();
+            for (int r = 0; r < rounds; r++) {
+                ddb_splitter_layout_compute_sizes (&input, widths, heights, results, NUM_SIZES);
+            }
+            double elapsed = now () - start;
+
+            for (int i = 0; i < NUM_SIZES; i++) {
+                input.area.width = widths[i];
+                input.area.height = heights[i];
+                if (!check (&input, &results[i])) {
+                    fprintf (stderr, "%s %s%s: bad layout for %dx%d\n", mode_names[mode],
+                            vertical ? "vertical" : "horizontal", limited ? " limited" : "", widths[i], heights[i]);
+                    failed = 1;
+                    break;
+                }
+            }
+
+            printf ("%-5s %-10s %-7s %8.2f million layouts/s\n", mode_names[mode],
+                    vertical ? "vertical" : "horizontal", limited ? "limited" : "",
+                    (double)rounds * NUM_SIZES / elapsed / 1e6);
+        }
+    }
+
+    return failed;
+}
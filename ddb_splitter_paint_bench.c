@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2016 Christian Boxdörfer <christian.boxdoerfer@posteo.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+/* Measures how much paint time #DdbSplitter:copy-on-move saves while a
+ * window is resized and a locked pane with expensive renderers only
+ * moves along. The pane is a nested splitter, so copying it covers the
+ * splitter inside as well. Every step is checked to look exactly the same
+ * with and without copying. Needs a display, but shows nothing: the
+ * layout lives in an offscreen window.
+ *
+ *   ddb_splitter_paint_bench [steps] */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <gtk/gtk.h>
+#include "ddb_splitter.h"
+
+#define NUM_STEPS 200
+/* how often the expensive renderer paints each pixel */
+#define HEAVY_PASSES 8
+#define PANE_WIDTH 300
+#define HEIGHT 400
+
+static gint64 paint_time;
+static gdouble painted_pixels;
+static guint paints;
+
+/* Paints a pattern in 8x8 blocks, HEAVY_PASSES times over */
+static void
+heavy_paint (cairo_t *cr)
+{
+    gdouble x1, y1, x2, y2;
+    gint64 start = g_get_monotonic_time ();
+
+    cairo_clip_extents (cr, &x1, &y1, &x2, &y2);
+    for (guint pass = 0; pass < HEAVY_PASSES; pass++) {
+        for (gdouble y = floor (y1 / 8) * 8; y < y2; y += 8) {
+            for (gdouble x = floor (x1 / 8) * 8; x < x2; x += 8) {
+                cairo_set_source_rgb (cr, fmod (x / 300 + pass * 0.1, 1.0), fmod (y / 400, 1.0), 0.5);
+                cairo_rectangle (cr, x, y, 8, 8);
+                cairo_fill (cr);
+            }
+        }
+    }
+
+    paint_time += g_get_monotonic_time () - start;
+    painted_pixels += (x2 - x1) * (y2 - y1);
+    paints++;
+}
+
+#if GTK_CHECK_VERSION(3,0,0)
+static gboolean
+heavy_draw (GtkWidget *widget, cairo_t *cr, gpointer user_data)
+{
+    heavy_paint (cr);
+    return FALSE;
+}
+#else
+static gboolean
+heavy_expose (GtkWidget *widget, GdkEventExpose *event, gpointer user_data)
+{
+    cairo_t *cr = gdk_cairo_create (event->window);
+    GtkAllocation allocation;
+
+    gtk_widget_get_allocation (widget, &allocation);
+    gdk_cairo_region (cr, event->region);
+    cairo_clip (cr);
+    cairo_translate (cr, allocation.x, allocation.y);
+    heavy_paint (cr);
+    cairo_destroy (cr);
+    return FALSE;
+}
+#endif
+
+static void
+bench_flush (void)
+{
+    while (gtk_events_pending ()) {
+        gtk_main_iteration ();
+    }
+    gdk_window_process_all_updates ();
+}
+
+/* A checksum of what @window shows */
+static gchar *
+bench_snapshot (GtkWidget *window)
+{
+    GdkPixbuf *pixbuf = gtk_offscreen_window_get_pixbuf (GTK_OFFSCREEN_WINDOW (window));
+    GChecksum *checksum = g_checksum_new (G_CHECKSUM_MD5);
+    const guchar *pixels = gdk_pixbuf_get_pixels (pixbuf);
+    gint rowstride = gdk_pixbuf_get_rowstride (pixbuf);
+    gint row_size = gdk_pixbuf_get_width (pixbuf) * gdk_pixbuf_get_n_channels (pixbuf);
+
+    /* the padding at the end of the rows isn't part of the image */
+    for (gint y = 0; y < gdk_pixbuf_get_height (pixbuf); y++) {
+        g_checksum_update (checksum, pixels + y * rowstride, row_size);
+    }
+
+    gchar *digest = g_strdup (g_checksum_get_string (checksum));
+    g_checksum_free (checksum);
+    g_object_unref (pixbuf);
+    return digest;
+}
+
+/* Grows and shrinks the window back and forth, so the locked pane moves
+ * by a few pixels per step without changing its size. What the window
+ * shows after each step goes into @snapshots */
+static void
+bench_run (GtkWidget *window, GtkWidget *splitter, guint steps, gchar **snapshots)
+{
+    paint_time = 0;
+    painted_pixels = 0;
+    paints = 0;
+
+    for (guint step = 0; step < steps; step++) {
+        gint width = PANE_WIDTH + 500 + 4 * (gint)(step % 100 < 50 ? step % 50 : 50 - step % 50);
+        gtk_widget_set_size_request (splitter, width, HEIGHT);
+        bench_flush ();
+        snapshots[step] = bench_snapshot (window);
+    }
+}
+
+static GtkWidget *
+heavy_new (void)
+{
+    GtkWidget *heavy = gtk_drawing_area_new ();
+
+    gtk_widget_set_has_window (heavy, FALSE);
+#if GTK_CHECK_VERSION(3,0,0)
+    g_signal_connect (heavy, "draw", G_CALLBACK (heavy_draw), NULL);
+#else
+    g_signal_connect (heavy, "expose-event", G_CALLBACK (heavy_expose), NULL);
+#endif
+    return heavy;
+}
+
+int
+main (int argc, char *argv[])
+{
+    guint steps = argc > 1 ? atoi (argv[1]) : NUM_STEPS;
+
+    gtk_init (&argc, &argv);
+
+    GtkWidget *window = gtk_offscreen_window_new ();
+    GtkWidget *splitter = ddb_splitter_new (GTK_ORIENTATION_HORIZONTAL);
+    GtkWidget *pane = ddb_splitter_new (GTK_ORIENTATION_VERTICAL);
+
+    ddb_splitter_add_child_at_pos (DDB_SPLITTER (pane), heavy_new (), 0);
+    ddb_splitter_add_child_at_pos (DDB_SPLITTER (pane), heavy_new (), 1);
+    ddb_splitter_add_child_at_pos (DDB_SPLITTER (splitter), gtk_label_new ("light pane"), 0);
+    ddb_splitter_add_child_at_pos (DDB_SPLITTER (splitter), pane, 1);
+    ddb_splitter_set_size_mode (DDB_SPLITTER (splitter), DDB_SPLITTER_SIZE_MODE_LOCK_C2);
+    ddb_splitter_set_locked_size (DDB_SPLITTER (splitter), PANE_WIDTH);
+    gtk_widget_set_size_request (splitter, PANE_WIDTH + 500, HEIGHT);
+    gtk_container_add (GTK_CONTAINER (window), splitter);
+    gtk_widget_show_all (window);
+    bench_flush ();
+
+    gint64 times[2];
+    gchar **snapshots[2];
+    for (guint copy = 0; copy < 2; copy++) {
+        DdbSplitterStats stats;
+        ddb_splitter_set_copy_on_move (DDB_SPLITTER (splitter), copy);
+        ddb_splitter_set_copy_on_move (DDB_SPLITTER (pane), copy);
+        ddb_splitter_reset_subtree_stats (splitter);
+        snapshots[copy] = g_new0 (gchar *, steps + 1);
+        bench_run (window, splitter, steps, snapshots[copy]);
+        ddb_splitter_get_subtree_stats (splitter, &stats);
+        times[copy] = paint_time;
+
+        g_print ("copy-on-move %-3s: %u steps, %u paints, %.1f Mpixels painted, %.1f ms painting, %" G_GUINT64_FORMAT " moves copied\n",
+                copy ? "on" : "off", steps, paints, painted_pixels / 1e6, paint_time / 1000.0,
+                stats.child_moves_copied);
+    }
+
+    if (times[0] > 0) {
+        g_print ("saved %.1f ms of paint time (%.0f%%)\n",
+                (times[0] - times[1]) / 1000.0, 100.0 * (times[0] - times[1]) / times[0]);
+    }
+
+    guint mismatches = 0;
+    for (guint step = 0; step < steps; step++) {
+        if (strcmp (snapshots[0][step], snapshots[1][step])) {
+            if (!mismatches) {
+                g_print ("step %u looks different with copy-on-move\n", step);
+            }
+            mismatches++;
+        }
+    }
+    g_print ("pixels: %u of %u steps differ\n", mismatches, steps);
+
+    g_strfreev (snapshots[0]);
+    g_strfreev (snapshots[1]);
+    gtk_widget_destroy (window);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2016 Christian Boxdörfer <christian.boxdoerfer@posteo.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <signal.h>
+#include <string.h>
+#include "ddb_splitter_remote.h"
+
+#ifdef GDK_WINDOWING_X11
+#if GTK_CHECK_VERSION(3,0,0)
+#include <gtk/gtkx.h>
+#include <gdk/gdkx.h>
+#endif
+
+/**
+ * SECTION: ddb-splitter-remote
+ * @title: Remote panes
+ * @short_description: Panes drawn by another process
+ *
+ * A remote pane shows a window of a separate process, embedded through
+ * XEmbed, so a slow or crashing plugin can't stall the UI. The pane is a
+ * #DdbSplitter in stack size mode: a placeholder is shown until the
+ * process has plugged its window into the #GtkSocket, and again when the
+ * process goes away. The socket has #DdbSplitter:defer-allocation set,
+ * so while the window is resized the process gets a new size every
+ * 100 ms instead of one per step. In between, its window keeps the old
+ * size, cut off or padded to the pane.
+ *
+ * The process lives as long as the pane is realized: it is sent SIGTERM
+ * when the pane is unrealized, removed or destroyed, and started again
+ * with the new window id of the socket when the pane is realized again.
+ **/
+
+#define DDB_SPLITTER_REMOTE_INTERVAL 100
+
+typedef struct
+{
+    GtkWidget *socket;
+    GtkWidget *placeholder;
+    gchar **argv;
+    GPid pid;
+    guint watch_id;
+} DdbSplitterRemote;
+
+static const gchar remote_key[] = "ddb-splitter-remote";
+
+static void
+ddb_splitter_remote_reap (GPid pid, gint status, gpointer user_data)
+{
+    g_spawn_close_pid (pid);
+}
+
+/* Asks the process to quit, it is reaped once it has exited */
+static void
+ddb_splitter_remote_stop (DdbSplitterRemote *remote)
+{
+    if (!remote->watch_id) {
+        return;
+    }
+    g_source_remove (remote->watch_id);
+    remote->watch_id = 0;
+    kill (remote->pid, SIGTERM);
+    g_child_watch_add (remote->pid, ddb_splitter_remote_reap, NULL);
+    remote->pid = 0;
+}
+
+static void
+ddb_splitter_remote_free (gpointer data)
+{
+    DdbSplitterRemote *remote = data;
+
+    ddb_splitter_remote_stop (remote);
+    g_strfreev (remote->argv);
+    g_free (remote);
+}
+
+static void
+ddb_splitter_remote_exited (GPid pid, gint status, gpointer user_data)
+{
+    DdbSplitter *pane = DDB_SPLITTER (user_data);
+    DdbSplitterRemote *remote = g_object_get_data (G_OBJECT (pane), remote_key);
+    gchar *text = g_strdup_printf ("%s exited", remote->argv[0]);
+
+    g_spawn_close_pid (pid);
+    remote->pid = 0;
+    remote->watch_id = 0;
+
+    gtk_label_set_text (GTK_LABEL (remote->placeholder), text);
+    ddb_splitter_set_active_child (pane, 0);
+    g_free (text);
+}
+
+/* Starts the process with the window id of the socket in its arguments */
+static gboolean
+ddb_splitter_remote_spawn (DdbSplitter *pane, DdbSplitterRemote *remote, GError **error)
+{
+    gchar *id = g_strdup_printf ("%lu", (gulong)gtk_socket_get_id (GTK_SOCKET (remote->socket)));
+    guint argc = g_strv_length (remote->argv);
+    gchar **argv = g_new0 (gchar *, argc + 1);
+    gboolean spawned;
+
+    for (guint i = 0; i < argc; i++) {
+        argv[i] = strcmp (remote->argv[i], DDB_SPLITTER_REMOTE_SOCKET_ID) ? remote->argv[i] : id;
+    }
+
+    spawned = g_spawn_async (NULL, argv, NULL, G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD,
+            NULL, NULL, &remote->pid, error);
+    if (spawned) {
+        remote->watch_id = g_child_watch_add (remote->pid, ddb_splitter_remote_exited, pane);
+    }
+
+    g_free (argv);
+    g_free (id);
+    return spawned;
+}
+
+/* The socket only gets a window id once the pane is realized, and a new
+ * one each time it is realized again */
+static void
+ddb_splitter_remote_realize (GtkWidget *widget, gpointer user_data)
+{
+    DdbSplitterRemote *remote = g_object_get_data (G_OBJECT (widget), remote_key);
+    GError *error = NULL;
+
+    if (remote->watch_id) {
+        return;
+    }
+    gtk_label_set_text (GTK_LABEL (remote->placeholder), "Starting...");
+    if (!ddb_splitter_remote_spawn (DDB_SPLITTER (widget), remote, &error)) {
+        gtk_label_set_text (GTK_LABEL (remote->placeholder), error->message);
+        g_error_free (error);
+    }
+}
+
+/* The window the process is plugged into goes away with the socket */
+static void
+ddb_splitter_remote_unrealize (GtkWidget *widget, gpointer user_data)
+{
+    DdbSplitterRemote *remote = g_object_get_data (G_OBJECT (widget), remote_key);
+
+    ddb_splitter_remote_stop (remote);
+    ddb_splitter_set_active_child (DDB_SPLITTER (widget), 0);
+}
+
+static void
+ddb_splitter_remote_plug_added (GtkSocket *socket, gpointer user_data)
+{
+    ddb_splitter_set_active_child (DDB_SPLITTER (user_data), 1);
+}
+
+static gboolean
+ddb_splitter_remote_plug_removed (GtkSocket *socket, gpointer user_data)
+{
+    DdbSplitterRemote *remote = g_object_get_data (G_OBJECT (user_data), remote_key);
+
+    gtk_label_set_text (GTK_LABEL (remote->placeholder), "Disconnected");
+    ddb_splitter_set_active_child (DDB_SPLITTER (user_data), 0);
+    /* keep the socket */
+    return TRUE;
+}
+
+/**
+ * ddb_splitter_add_remote_child:
+ * @splitter : a #DdbSplitter.
+ * @pos      : the slot to put the pane into, 0 or 1.
+ * @argv     : the command line of the process drawing the pane.
+ * @error    : return location for a #GError, or %NULL.
+ *
+ * Puts a pane into slot @pos of @splitter whose contents are drawn by a
+ * separate process, started from @argv. Arguments equal to
+ * %DDB_SPLITTER_REMOTE_SOCKET_ID are replaced by the window id the
+ * process has to plug its window into, e.g. with gtk_plug_new().
+ *
+ * The process is started once the pane is realized. If that happens
+ * right away and the process can't be started, the pane is removed again
+ * and @error is set; otherwise the error is shown in the pane. On a
+ * display other than X11, e.g. with GTK 3 on Wayland, no pane is added
+ * and @error is set to %DDB_SPLITTER_ERROR_UNSUPPORTED. If slot @pos is
+ * taken already, @error is set to %DDB_SPLITTER_ERROR_DUPLICATE_SLOT.
+ *
+ * Returns: %TRUE unless the pane couldn't be added or the process
+ * couldn't be started.
+ **/
+gboolean
+ddb_splitter_add_remote_child (DdbSplitter *splitter, guint pos, gchar **argv, GError **error)
+{
+    g_return_val_if_fail (DDB_IS_SPLITTER (splitter), FALSE);
+    g_return_val_if_fail (pos <= 1, FALSE);
+    g_return_val_if_fail (argv != NULL && argv[0] != NULL, FALSE);
+    g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+#if GTK_CHECK_VERSION(3,0,0)
+    if (!GDK_IS_X11_DISPLAY (gtk_widget_get_display (GTK_WIDGET (splitter)))) {
+        g_set_error (error, DDB_SPLITTER_ERROR, DDB_SPLITTER_ERROR_UNSUPPORTED,
+                "Remote panes need an X11 display");
+        return FALSE;
+    }
+#endif
+
+    DdbSplitterRemote *remote = g_new0 (DdbSplitterRemote, 1);
+    GtkWidget *pane = ddb_splitter_new (GTK_ORIENTATION_HORIZONTAL);
+
+    remote->argv = g_strdupv (argv);
+    remote->placeholder = gtk_label_new ("Starting...");
+    remote->socket = gtk_socket_new ();
+    g_object_set_data_full (G_OBJECT (pane), remote_key, remote, ddb_splitter_remote_free);
+
+    ddb_splitter_set_size_mode (DDB_SPLITTER (pane), DDB_SPLITTER_SIZE_MODE_STACK);
+    ddb_splitter_set_defer_interval (DDB_SPLITTER (pane), DDB_SPLITTER_REMOTE_INTERVAL);
+    ddb_splitter_add_child_at_pos (DDB_SPLITTER (pane), remote->placeholder, 0);
+    ddb_splitter_add_child_at_pos (DDB_SPLITTER (pane), remote->socket, 1);
+    gtk_container_child_set (GTK_CONTAINER (pane), remote->socket, "defer-allocation", TRUE, NULL);
+
+    g_signal_connect (remote->socket, "plug-added", G_CALLBACK (ddb_splitter_remote_plug_added), pane);
+    g_signal_connect (remote->socket, "plug-removed", G_CALLBACK (ddb_splitter_remote_plug_removed), pane);
+    gtk_widget_show_all (pane);
+
+    if (!ddb_splitter_add_child_at_pos (splitter, pane, pos)) {
+        g_object_ref_sink (pane);
+        gtk_widget_destroy (pane);
+        g_object_unref (pane);
+        g_set_error (error, DDB_SPLITTER_ERROR, DDB_SPLITTER_ERROR_DUPLICATE_SLOT,
+                "Slot %u of the splitter is taken already", pos);
+        return FALSE;
+    }
+
+    g_signal_connect_after (pane, "realize", G_CALLBACK (ddb_splitter_remote_realize), NULL);
+    g_signal_connect (pane, "unrealize", G_CALLBACK (ddb_splitter_remote_unrealize), NULL);
+    if (gtk_widget_get_realized (pane) && !ddb_splitter_remote_spawn (DDB_SPLITTER (pane), remote, error)) {
+        gtk_container_remove (GTK_CONTAINER (splitter), pane);
+        return FALSE;
+    }
+    return TRUE;
+}
+#endif
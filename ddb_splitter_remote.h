@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2016 Christian Boxdörfer <christian.boxdoerfer@posteo.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef __DDB_SPLITTER_REMOTE_H__
+#define __DDB_SPLITTER_REMOTE_H__
+
+#include "ddb_splitter.h"
+
+G_BEGIN_DECLS
+
+#ifdef GDK_WINDOWING_X11
+/* Replaced by the window id of the socket in the arguments of
+ * ddb_splitter_add_remote_child() */
+#define DDB_SPLITTER_REMOTE_SOCKET_ID "{socket-id}"
+
+gboolean
+ddb_splitter_add_remote_child (DdbSplitter *splitter, guint pos, gchar **argv, GError **error);
+#endif
+
+G_END_DECLS
+
+#endif /* !__DDB_SPLITTER_REMOTE_H__ */
@@ -17,8 +17,22 @@
  * MA 02110-1301 USA
  */
 
+#include <string.h>
 #include "ddb_splitter_size_mode.h"
 
+/* short names used in serialized layout descriptions */
+static const struct
+{
+    DdbSplitterSizeMode size_mode;
+    const gchar *token;
+} size_mode_tokens[] =
+{
+    { DDB_SPLITTER_SIZE_MODE_PROP,    "prop",  },
+    { DDB_SPLITTER_SIZE_MODE_LOCK_C1, "lock1", },
+    { DDB_SPLITTER_SIZE_MODE_LOCK_C2, "lock2", },
+    { DDB_SPLITTER_SIZE_MODE_STACK,   "stack", },
+};
+
 GType
 ddb_splitter_size_mode_get_type (void)
 {
@@ -31,6 +45,7 @@ ddb_splitter_size_mode_get_type (void)
             { DDB_SPLITTER_SIZE_MODE_PROP,   "DDB_SPLITTER_SIZE_MODE_PROP",   "Proportional sizing",       },
             { DDB_SPLITTER_SIZE_MODE_LOCK_C1, "DDB_SPLITTER_SIZE_MODE_LOCK_C1", "Size of first child is locked",     },
             { DDB_SPLITTER_SIZE_MODE_LOCK_C2,   "DDB_SPLITTER_SIZE_MODE_LOCK_C2", "Size of second child is locked", },
+            { DDB_SPLITTER_SIZE_MODE_STACK,   "DDB_SPLITTER_SIZE_MODE_STACK", "Only the active child is shown", },
             { 0, NULL, NULL, },
         };
 
@@ -39,3 +54,45 @@ ddb_splitter_size_mode_get_type (void)
 
     return type;
 }
+
+/**
+ * ddb_splitter_size_mode_to_token:
+ * @size_mode : a #DdbSplitterSizeMode.
+ *
+ * Returns the short name of @size_mode as used in layout descriptions.
+ *
+ * Returns: a static string, or %NULL if @size_mode is invalid.
+ **/
+const gchar *
+ddb_splitter_size_mode_to_token (DdbSplitterSizeMode size_mode)
+{
+    for (guint i = 0; i < G_N_ELEMENTS (size_mode_tokens); i++) {
+        if (size_mode_tokens[i].size_mode == size_mode) {
+            return size_mode_tokens[i].token;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * ddb_splitter_size_mode_from_token:
+ * @token     : the short name, not necessarily nul-terminated.
+ * @len       : the length of @token.
+ * @size_mode : return location for the size mode.
+ *
+ * Looks up the size mode with the short name @token.
+ *
+ * Returns: %TRUE if @token names a size mode.
+ **/
+gboolean
+ddb_splitter_size_mode_from_token (const gchar *token, gsize len, DdbSplitterSizeMode *size_mode)
+{
+    for (guint i = 0; i < G_N_ELEMENTS (size_mode_tokens); i++) {
+        if (strlen (size_mode_tokens[i].token) == len
+                && strncmp (size_mode_tokens[i].token, token, len) == 0) {
+            *size_mode = size_mode_tokens[i].size_mode;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
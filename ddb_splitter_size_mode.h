@@ -31,10 +31,14 @@ typedef enum
     DDB_SPLITTER_SIZE_MODE_PROP,
     DDB_SPLITTER_SIZE_MODE_LOCK_C1,
     DDB_SPLITTER_SIZE_MODE_LOCK_C2,
+    DDB_SPLITTER_SIZE_MODE_STACK,
 } DdbSplitterSizeMode;
 
 GType ddb_splitter_size_mode_get_type (void) G_GNUC_CONST;
 
+const gchar *ddb_splitter_size_mode_to_token (DdbSplitterSizeMode size_mode);
+gboolean ddb_splitter_size_mode_from_token (const gchar *token, gsize len, DdbSplitterSizeMode *size_mode);
+
 G_END_DECLS
 
 #endif /* !__DDB_SPLITTER_SIZE_MODE_H__ */
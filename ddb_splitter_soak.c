@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 2016 Christian Boxdörfer <christian.boxdoerfer@posteo.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+/* Soak test: rearranges a splitter layout over and over and fails if the
+ * memory use or the number of live objects keeps growing.
+ *
+ *   ddb_splitter_soak [cycles] [samples]
+ *
+ * Needs a display. The layout lives in a popup window placed off the
+ * screen, which has to be mapped for the pointer grabs of the dragged
+ * handles, so better run it under Xvfb. Object counts need GLib 2.44 or
+ * newer. With GTK2, cursors aren't objects; the ones the splitter creates
+ * are counted by linking with -Wl,--wrap for the cursor functions, see
+ * the soak target in the Makefile. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include <gtk/gtk.h>
+#include "ddb_splitter.h"
+
+#define NUM_CYCLES 1000000
+#define NUM_SAMPLES 100
+/* how much memory use may grow between the warm-up and the end */
+#define GROWTH_SLACK (1024 * 1024)
+
+typedef struct
+{
+    guint64 cycle;
+    gint64 rss;
+    gint64 heap;
+    gint splitters;
+    gint labels;
+    gint windows;
+    gint cursors;
+} SoakSample;
+
+static GType window_type;
+#if GTK_CHECK_VERSION(3,0,0)
+static GType cursor_type;
+#endif
+static gint cursors;
+
+/* GTK2 cursors aren't objects, count the ones the splitter creates */
+GdkCursor *__real_gdk_cursor_new_for_display (GdkDisplay *display, GdkCursorType type);
+void __real_gdk_cursor_unref (GdkCursor *cursor);
+
+GdkCursor *
+__wrap_gdk_cursor_new_for_display (GdkDisplay *display, GdkCursorType type)
+{
+    GdkCursor *cursor = __real_gdk_cursor_new_for_display (display, type);
+    if (cursor) {
+        cursors++;
+    }
+    return cursor;
+}
+
+void
+__wrap_gdk_cursor_unref (GdkCursor *cursor)
+{
+    cursors--;
+    __real_gdk_cursor_unref (cursor);
+}
+
+static gint64
+soak_rss (void)
+{
+    FILE *fp = fopen ("/proc/self/statm", "r");
+    long size = 0;
+    long resident = 0;
+
+    if (!fp) {
+        return -1;
+    }
+    if (fscanf (fp, "%ld %ld", &size, &resident) != 2) {
+        resident = -1;
+    }
+    fclose (fp);
+    return resident < 0 ? -1 : (gint64)resident * sysconf (_SC_PAGESIZE);
+}
+
+static gint64
+soak_heap (void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    struct mallinfo2 info = mallinfo2 ();
+    return info.uordblks;
+#else
+    return -1;
+#endif
+}
+
+static gint
+soak_instances (GType type)
+{
+#if GLIB_CHECK_VERSION(2,44,0)
+    return type ? g_type_get_instance_count (type) : -1;
+#else
+    return -1;
+#endif
+}
+
+static void
+soak_sample (SoakSample *sample, guint64 cycle)
+{
+    sample->cycle = cycle;
+    sample->rss = soak_rss ();
+    sample->heap = soak_heap ();
+    sample->splitters = soak_instances (DDB_TYPE_SPLITTER);
+    sample->labels = soak_instances (GTK_TYPE_LABEL);
+    sample->windows = soak_instances (window_type);
+#if GTK_CHECK_VERSION(3,0,0)
+    sample->cursors = soak_instances (cursor_type);
+#else
+    sample->cursors = cursors;
+#endif
+}
+
+static void
+soak_flush (void)
+{
+    while (gtk_events_pending ()) {
+        gtk_main_iteration ();
+    }
+}
+
+/* The handle window of @splitter, if it is shown */
+static GdkWindow *
+soak_handle (DdbSplitter *splitter)
+{
+    GdkWindow *handle = NULL;
+    GList *windows = gdk_window_get_children (gtk_widget_get_window (GTK_WIDGET (splitter)));
+
+    for (GList *l = windows; l; l = l->next) {
+        gpointer owner = NULL;
+        gdk_window_get_user_data (l->data, &owner);
+        if (owner == splitter && gdk_window_is_visible (l->data)) {
+            handle = l->data;
+            break;
+        }
+    }
+    g_list_free (windows);
+    return handle;
+}
+
+/* Sends a button or motion event at @x, @y of @window through GTK, as if
+ * the pointer did it */
+static void
+soak_send (GdkWindow *window, GdkEventType type, gdouble x, gdouble y)
+{
+    GdkEvent *event = gdk_event_new (type);
+
+    if (type == GDK_MOTION_NOTIFY) {
+        event->motion.window = g_object_ref (window);
+        event->motion.send_event = TRUE;
+        event->motion.time = GDK_CURRENT_TIME;
+        event->motion.x = x;
+        event->motion.y = y;
+        event->motion.state = GDK_BUTTON1_MASK;
+        event->motion.is_hint = FALSE;
+    }
+    else {
+        event->button.window = g_object_ref (window);
+        event->button.send_event = TRUE;
+        event->button.time = GDK_CURRENT_TIME;
+        event->button.x = x;
+        event->button.y = y;
+        event->button.button = 1;
+        event->button.state = type == GDK_BUTTON_RELEASE ? GDK_BUTTON1_MASK : 0;
+    }
+#if GTK_CHECK_VERSION(3,20,0)
+    gdk_event_set_device (event, gdk_seat_get_pointer (gdk_display_get_default_seat (gdk_window_get_display (window))));
+#elif GTK_CHECK_VERSION(3,0,0)
+    gdk_event_set_device (event, gdk_device_manager_get_client_pointer (
+                gdk_display_get_device_manager (gdk_window_get_display (window))));
+#endif
+    gtk_main_do_event (event);
+    gdk_event_free (event);
+}
+
+/* Drags the handle of @splitter in steps to @fraction of its size and
+ * lets go, with the events a user would cause */
+static void
+soak_drag (DdbSplitter *splitter, gfloat fraction)
+{
+    GdkWindow *handle = soak_handle (splitter);
+    GtkAllocation a;
+    gint hx, hy;
+
+    if (!handle) {
+        return;
+    }
+    gtk_widget_get_allocation (GTK_WIDGET (splitter), &a);
+    gdk_window_get_position (handle, &hx, &hy);
+    gboolean horizontal = ddb_splitter_get_orientation (splitter) == GTK_ORIENTATION_HORIZONTAL;
+
+    soak_send (handle, GDK_BUTTON_PRESS, 1, 1);
+    for (guint step = 1; step <= 4; step++) {
+        gfloat f = fraction * step / 4.0f;
+        soak_send (handle, GDK_MOTION_NOTIFY,
+                horizontal ? a.x + a.width * f - hx : 1,
+                horizontal ? 1 : a.y + a.height * f - hy);
+        soak_flush ();
+    }
+    soak_send (handle, GDK_BUTTON_RELEASE, 1, 1);
+    soak_flush ();
+}
+
+/* One round of rearranging: fill the splitter with a pane and a nested
+ * splitter, switch modes and orientation, move the handle around, and
+ * empty it again */
+static void
+soak_cycle (GtkWidget *window, DdbSplitter *splitter, guint64 cycle)
+{
+    static const DdbSplitterSizeMode modes[] = {
+        DDB_SPLITTER_SIZE_MODE_PROP,
+        DDB_SPLITTER_SIZE_MODE_LOCK_C1,
+        DDB_SPLITTER_SIZE_MODE_LOCK_C2,
+        DDB_SPLITTER_SIZE_MODE_STACK,
+    };
+    GtkWidget *nested = ddb_splitter_new (GTK_ORIENTATION_VERTICAL);
+    GtkWidget *pane = gtk_label_new ("pane");
+
+    ddb_splitter_add_child_at_pos (DDB_SPLITTER (nested), gtk_label_new ("nested 1"), 0);
+    ddb_splitter_add_child_at_pos (DDB_SPLITTER (nested), gtk_label_new ("nested 2"), 1);
+    gtk_widget_show_all (nested);
+    gtk_widget_show (pane);
+    ddb_splitter_add_child_at_pos (splitter, pane, 0);
+    ddb_splitter_add_child_at_pos (splitter, nested, 1);
+    soak_flush ();
+
+    ddb_splitter_set_size_mode (splitter, modes[cycle % G_N_ELEMENTS (modes)]);
+    ddb_splitter_set_size_mode (DDB_SPLITTER (nested), modes[(cycle + 1) % G_N_ELEMENTS (modes)]);
+    soak_flush ();
+
+    g_object_set (splitter, "orientation",
+            cycle & 1 ? GTK_ORIENTATION_VERTICAL : GTK_ORIENTATION_HORIZONTAL, NULL);
+    soak_flush ();
+
+    soak_drag (splitter, (cycle % 4 + 1) / 5.0f);
+    soak_drag (DDB_SPLITTER (nested), 1.0f - (cycle % 4 + 1) / 5.0f);
+
+    /* destroys and recreates the handle windows */
+    if (cycle % 16 == 0) {
+        gtk_widget_hide (window);
+        gtk_widget_unrealize (window);
+        gtk_widget_show (window);
+        soak_flush ();
+    }
+
+    ddb_splitter_remove_c1 (splitter);
+    ddb_splitter_remove_c2 (splitter);
+    soak_flush ();
+}
+
+/* Whether @later grew from @earlier by more than @slack */
+static gboolean
+soak_grew (const char *what, gint64 earlier, gint64 later, gint64 slack)
+{
+    if (earlier < 0 || later < 0 || later - earlier <= slack) {
+        return FALSE;
+    }
+    fprintf (stderr, "%s grew from %" G_GINT64_FORMAT " to %" G_GINT64_FORMAT "\n", what, earlier, later);
+    return TRUE;
+}
+
+int
+main (int argc, char *argv[])
+{
+    guint64 cycles = argc > 1 ? g_ascii_strtoull (argv[1], NULL, 10) : NUM_CYCLES;
+    guint num_samples = argc > 2 ? atoi (argv[2]) : NUM_SAMPLES;
+
+#if GLIB_CHECK_VERSION(2,44,0)
+    /* instance counting has to be switched on before GObject starts up */
+    const gchar *debug = g_getenv ("GOBJECT_DEBUG");
+    if (!debug || !strstr (debug, "instance-count")) {
+        gchar *value = g_strconcat (debug ? debug : "", debug ? "," : "", "instance-count", NULL);
+        g_setenv ("GOBJECT_DEBUG", value, TRUE);
+        execv ("/proc/self/exe", argv);
+        g_free (value);
+        fprintf (stderr, "can't restart with object counts, going on without them\n");
+    }
+#endif
+
+    gtk_init (&argc, &argv);
+
+    if (num_samples < 8) {
+        num_samples = 8;
+    }
+    if (cycles < num_samples) {
+        cycles = num_samples;
+    }
+
+    GtkWidget *window = gtk_window_new (GTK_WINDOW_POPUP);
+    GtkWidget *splitter = ddb_splitter_new (GTK_ORIENTATION_HORIZONTAL);
+    gtk_window_set_default_size (GTK_WINDOW (window), 640, 480);
+    gtk_window_move (GTK_WINDOW (window), -10000, -10000);
+    gtk_container_add (GTK_CONTAINER (window), splitter);
+    gtk_widget_show_all (window);
+    soak_flush ();
+
+    window_type = G_OBJECT_TYPE (gtk_widget_get_window (window));
+#if GTK_CHECK_VERSION(3,0,0)
+    GdkCursor *cursor = gdk_cursor_new_for_display (gtk_widget_get_display (window), GDK_SB_H_DOUBLE_ARROW);
+    cursor_type = G_OBJECT_TYPE (cursor);
+    g_object_unref (cursor);
+#endif
+
+    SoakSample *samples = g_new0 (SoakSample, num_samples);
+    guint64 interval = cycles / num_samples;
+    gint64 start = g_get_monotonic_time ();
+    DdbSplitterStats stats;
+
+    printf ("%10s %10s %10s %9s %7s %7s %7s %10s %10s\n", "cycle", "rss KiB", "heap KiB",
+            "splitters", "labels", "windows", "cursors", "cycles/s", "allocs/s");
+    for (guint s = 0; s < num_samples; s++) {
+        gint64 sample_start = g_get_monotonic_time ();
+        ddb_splitter_reset_subtree_stats (splitter);
+
+        for (guint64 c = 0; c < interval; c++) {
+            soak_cycle (window, DDB_SPLITTER (splitter), s * interval + c);
+        }
+
+        gdouble elapsed = (g_get_monotonic_time () - sample_start) / 1e6;
+        ddb_splitter_get_subtree_stats (splitter, &stats);
+        soak_sample (&samples[s], (s + 1) * interval);
+        printf ("%10" G_GUINT64_FORMAT " %10" G_GINT64_FORMAT " %10" G_GINT64_FORMAT " %9d %7d %7d %7d %10.0f %10.0f\n",
+                samples[s].cycle, samples[s].rss / 1024, samples[s].heap / 1024,
+                samples[s].splitters, samples[s].labels, samples[s].windows, samples[s].cursors,
+                interval / elapsed, stats.size_allocate_calls / elapsed);
+        fflush (stdout);
+    }
+
+    /* the first tenth warms up caches and pools; after that everything
+     * has to stay flat, the object counts exactly */
+    const SoakSample *warm = &samples[num_samples / 10];
+    const SoakSample *last = &samples[num_samples - 1];
+    gboolean failed = FALSE;
+    failed |= soak_grew ("RSS", warm->rss, last->rss, GROWTH_SLACK + warm->rss / 20);
+    failed |= soak_grew ("heap", warm->heap, last->heap, GROWTH_SLACK);
+    failed |= soak_grew ("splitters", warm->splitters, last->splitters, 0);
+    failed |= soak_grew ("labels", warm->labels, last->labels, 0);
+    failed |= soak_grew ("GdkWindows", warm->windows, last->windows, 0);
+    failed |= soak_grew ("cursors", warm->cursors, last->cursors, 0);
+
+    if (warm->heap >= 0 && last->cycle > warm->cycle) {
+        printf ("heap growth: %.2f bytes per cycle\n",
+                (gdouble)(last->heap - warm->heap) / (last->cycle - warm->cycle));
+    }
+    printf ("%" G_GUINT64_FORMAT " cycles in %.1f s: %s\n", last->cycle,
+            (g_get_monotonic_time () - start) / 1e6, failed ? "FAILED" : "ok");
+
+    g_free (samples);
+    gtk_widget_destroy (window);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2016 Christian Boxdörfer <christian.boxdoerfer@posteo.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include "ddb_splitter_sync_group.h"
+
+/**
+ * SECTION: ddb-splitter-sync-group
+ * @title: DdbSplitterSyncGroup
+ * @short_description: Keeps the handles of several splitters aligned
+ *
+ * All splitters of a #DdbSplitterSyncGroup share the same proportion and
+ * locked size. Changing one member, e.g. by dragging its handle, updates
+ * all other members in one go. Their resizes are queued together and
+ * handled in a single layout pass, and property notifications are only
+ * emitted once every member has the new value, so handlers connected to
+ * the members can't bounce the value back and forth.
+ **/
+
+#define DDB_SPLITTER_SYNC_GROUP_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
+            DDB_TYPE_SPLITTER_SYNC_GROUP, DdbSplitterSyncGroupPrivate))
+
+struct _DdbSplitterSyncGroupPrivate
+{
+    GSList *splitters;
+    guint syncing : 1;
+};
+
+G_DEFINE_TYPE (DdbSplitterSyncGroup, ddb_splitter_sync_group, G_TYPE_OBJECT)
+
+static void
+ddb_splitter_sync_group_class_init (DdbSplitterSyncGroupClass *klass)
+{
+    /* add our private data to the class */
+    g_type_class_add_private (klass, sizeof (DdbSplitterSyncGroupPrivate));
+}
+
+static void
+ddb_splitter_sync_group_init (DdbSplitterSyncGroup *group)
+{
+    /* grab a pointer on the private data */
+    group->priv = DDB_SPLITTER_SYNC_GROUP_GET_PRIVATE (group);
+
+    group->priv->splitters = NULL;
+    group->priv->syncing = FALSE;
+}
+
+/**
+ * ddb_splitter_sync_group_new:
+ *
+ * Creates a new, empty sync group.
+ *
+ * Returns: a new #DdbSplitterSyncGroup.
+ **/
+DdbSplitterSyncGroup *
+ddb_splitter_sync_group_new (void)
+{
+    return g_object_new (DDB_TYPE_SPLITTER_SYNC_GROUP, NULL);
+}
+
+/**
+ * ddb_splitter_sync_group_add_splitter:
+ * @group    : a #DdbSplitterSyncGroup.
+ * @splitter : the #DdbSplitter to add.
+ *
+ * Adds @splitter to @group, removing it from any other group. The
+ * splitter takes over the proportion and locked size of the group.
+ * The group is kept alive as long as it has members.
+ **/
+void
+ddb_splitter_sync_group_add_splitter (DdbSplitterSyncGroup *group, DdbSplitter *splitter)
+{
+    g_return_if_fail (DDB_IS_SPLITTER_SYNC_GROUP (group));
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+
+    ddb_splitter_set_sync_group (splitter, group);
+}
+
+/**
+ * ddb_splitter_sync_group_remove_splitter:
+ * @group    : a #DdbSplitterSyncGroup.
+ * @splitter : the #DdbSplitter to remove.
+ *
+ * Removes @splitter from @group.
+ **/
+void
+ddb_splitter_sync_group_remove_splitter (DdbSplitterSyncGroup *group, DdbSplitter *splitter)
+{
+    g_return_if_fail (DDB_IS_SPLITTER_SYNC_GROUP (group));
+    g_return_if_fail (DDB_IS_SPLITTER (splitter));
+
+    if (ddb_splitter_get_sync_group (splitter) == group) {
+        ddb_splitter_set_sync_group (splitter, NULL);
+    }
+}
+
+/**
+ * ddb_splitter_sync_group_get_splitters:
+ * @group : a #DdbSplitterSyncGroup.
+ *
+ * Returns: (transfer none): the members of @group. The list is owned
+ * by the group and must not be modified.
+ **/
+GSList *
+ddb_splitter_sync_group_get_splitters (DdbSplitterSyncGroup *group)
+{
+    g_return_val_if_fail (DDB_IS_SPLITTER_SYNC_GROUP (group), NULL);
+    return group->priv->splitters;
+}
+
+void
+_ddb_splitter_sync_group_attach (DdbSplitterSyncGroup *group, DdbSplitter *splitter)
+{
+    DdbSplitter *first = group->priv->splitters ? group->priv->splitters->data : NULL;
+
+    group->priv->splitters = g_slist_append (group->priv->splitters, splitter);
+    if (first) {
+        /* take over the values of the group */
+        _ddb_splitter_sync_group_propagate (group, first);
+    }
+}
+
+void
+_ddb_splitter_sync_group_detach (DdbSplitterSyncGroup *group, DdbSplitter *splitter)
+{
+    group->priv->splitters = g_slist_remove (group->priv->splitters, splitter);
+}
+
+void
+_ddb_splitter_sync_group_propagate (DdbSplitterSyncGroup *group, DdbSplitter *source)
+{
+    if (group->priv->syncing) {
+        return;
+    }
+
+    gfloat proportion = ddb_splitter_get_proportion (source);
+    gint locked_size = ddb_splitter_get_locked_size (source);
+    GSList *l;
+
+    group->priv->syncing = TRUE;
+    g_object_ref (group);
+
+    for (l = group->priv->splitters; l; l = l->next) {
+        g_object_freeze_notify (G_OBJECT (l->data));
+    }
+    for (l = group->priv->splitters; l; l = l->next) {
+        DdbSplitter *splitter = l->data;
+        if (splitter == source) {
+            continue;
+        }
+        ddb_splitter_set_proportion (splitter, proportion);
+        if (locked_size >= 0) {
+            ddb_splitter_set_locked_size (splitter, locked_size);
+        }
+    }
+
+    group->priv->syncing = FALSE;
+
+    /* all members are up to date now, notify handlers may safely
+     * change them again */
+    GSList *splitters = g_slist_copy (group->priv->splitters);
+    for (l = splitters; l; l = l->next) {
+        g_object_thaw_notify (G_OBJECT (l->data));
+    }
+    g_slist_free (splitters);
+
+    g_object_unref (group);
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2016 Christian Boxdörfer <christian.boxdoerfer@posteo.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef __DDB_SPLITTER_SYNC_GROUP_H__
+#define __DDB_SPLITTER_SYNC_GROUP_H__
+
+#include "ddb_splitter.h"
+
+G_BEGIN_DECLS
+
+typedef struct _DdbSplitterSyncGroupPrivate DdbSplitterSyncGroupPrivate;
+typedef struct _DdbSplitterSyncGroupClass   DdbSplitterSyncGroupClass;
+
+#define DDB_TYPE_SPLITTER_SYNC_GROUP             (ddb_splitter_sync_group_get_type ())
+#define DDB_SPLITTER_SYNC_GROUP(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), DDB_TYPE_SPLITTER_SYNC_GROUP, DdbSplitterSyncGroup))
+#define DDB_SPLITTER_SYNC_GROUP_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), DDB_TYPE_SPLITTER_SYNC_GROUP, DdbSplitterSyncGroupClass))
+#define DDB_IS_SPLITTER_SYNC_GROUP(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), DDB_TYPE_SPLITTER_SYNC_GROUP))
+#define DDB_IS_SPLITTER_SYNC_GROUP_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), DDB_TYPE_SPLITTER_SYNC_GROUP))
+#define DDB_SPLITTER_SYNC_GROUP_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), DDB_TYPE_SPLITTER_SYNC_GROUP, DdbSplitterSyncGroupClass))
+
+struct _DdbSplitterSyncGroupClass
+{
+  /*< private >*/
+  GObjectClass __parent__;
+};
+
+/**
+ * DdbSplitterSyncGroup:
+ *
+ *  The #DdbSplitterSyncGroup struct contains only private fields
+ * and should not be directly accessed.
+ **/
+struct _DdbSplitterSyncGroup
+{
+  /*< private >*/
+  GObject                      __parent__;
+  DdbSplitterSyncGroupPrivate *priv;
+};
+
+GType
+ddb_splitter_sync_group_get_type (void) G_GNUC_CONST;
+
+DdbSplitterSyncGroup
+*ddb_splitter_sync_group_new (void);
+
+void
+ddb_splitter_sync_group_add_splitter (DdbSplitterSyncGroup *group, DdbSplitter *splitter);
+void
+ddb_splitter_sync_group_remove_splitter (DdbSplitterSyncGroup *group, DdbSplitter *splitter);
+GSList *
+ddb_splitter_sync_group_get_splitters (DdbSplitterSyncGroup *group);
+
+/* used by DdbSplitter */
+void
+_ddb_splitter_sync_group_attach (DdbSplitterSyncGroup *group, DdbSplitter *splitter);
+void
+_ddb_splitter_sync_group_detach (DdbSplitterSyncGroup *group, DdbSplitter *splitter);
+void
+_ddb_splitter_sync_group_propagate (DdbSplitterSyncGroup *group, DdbSplitter *source);
+
+G_END_DECLS
+
+#endif /* !__DDB_SPLITTER_SYNC_GROUP_H__ */
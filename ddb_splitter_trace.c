@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2016 Christian Boxdörfer <christian.boxdoerfer@posteo.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#include "ddb_splitter_trace.h"
+
+/**
+ * SECTION: ddb-splitter-trace
+ * @title: Tracing
+ * @short_description: Records a timeline of what splitters are doing
+ *
+ * While tracing is active every #DdbSplitter records begin and end events
+ * for size requests, size allocations, child allocations, handle
+ * painting, drag motion handling and property changes. Each event
+ * carries the address of the splitter and its nesting depth.
+ *
+ * The events are kept in a fixed size ring buffer, so only the most
+ * recent DDB_SPLITTER_TRACE_BUFFER_SIZE events are available.
+ * ddb_splitter_trace_write() stores them in the Chrome trace-event JSON
+ * format, which can be loaded into chrome://tracing or Perfetto.
+ *
+ * Setting the environment variable DDB_SPLITTER_TRACE to a filename
+ * starts tracing when the first splitter is created and writes the
+ * trace to that file when the program exits.
+ **/
+
+#define DDB_SPLITTER_TRACE_BUFFER_SIZE 65536
+
+typedef struct
+{
+    /* tag of the serial number of the event stored here, 0 while it's
+     * written, see DDB_SPLITTER_TRACE_TAG() */
+    volatile gint serial;
+    gint tid;
+    gchar phase;
+    guint depth;
+    const gchar *name;
+    gconstpointer id;
+    gint64 time;
+} DdbSplitterTraceEvent;
+
+volatile gint _ddb_splitter_trace_active = FALSE;
+
+/* Serial numbers wrap around at 2^32, which is a multiple of the buffer
+ * size, so each slot keeps getting the same serial numbers modulo the
+ * buffer size. A stored serial number is never 0 */
+#define DDB_SPLITTER_TRACE_TAG(serial) ((gint)((serial) + 1 ? (serial) + 1 : 1))
+
+static DdbSplitterTraceEvent trace_events[DDB_SPLITTER_TRACE_BUFFER_SIZE];
+static volatile guint trace_head = 0;
+static gchar *trace_exit_filename = NULL;
+/* id + 1 of the calling thread */
+static GPrivate trace_tid = G_PRIVATE_INIT (NULL);
+
+static gint
+ddb_splitter_trace_tid (void)
+{
+    gint tid = GPOINTER_TO_INT (g_private_get (&trace_tid));
+
+    if (G_UNLIKELY (tid == 0)) {
+#ifdef SYS_gettid
+        tid = (gint)syscall (SYS_gettid) + 1;
+#else
+        static volatile gint next_tid = 0;
+        tid = g_atomic_int_add (&next_tid, 1) + 2;
+#endif
+        g_private_set (&trace_tid, GINT_TO_POINTER (tid));
+    }
+    return tid - 1;
+}
+
+static void
+ddb_splitter_trace_write_at_exit (void)
+{
+    GError *error = NULL;
+
+    if (!ddb_splitter_trace_write (trace_exit_filename, &error)) {
+        g_printerr ("DdbSplitter: failed to write trace: %s\n", error->message);
+        g_error_free (error);
+    }
+}
+
+/* Called from the class init of DdbSplitter */
+void
+_ddb_splitter_trace_init (void)
+{
+    const gchar *filename = g_getenv ("DDB_SPLITTER_TRACE");
+
+    if (filename && *filename && !trace_exit_filename) {
+        trace_exit_filename = g_strdup (filename);
+        ddb_splitter_trace_start ();
+        atexit (ddb_splitter_trace_write_at_exit);
+    }
+}
+
+/**
+ * ddb_splitter_trace_start:
+ *
+ * Discards all recorded events and starts recording.
+ **/
+void
+ddb_splitter_trace_start (void)
+{
+    g_atomic_int_set (&_ddb_splitter_trace_active, FALSE);
+    for (guint i = 0; i < DDB_SPLITTER_TRACE_BUFFER_SIZE; i++) {
+        g_atomic_int_set (&trace_events[i].serial, 0);
+    }
+    g_atomic_int_set ((volatile gint *)&trace_head, 0);
+    g_atomic_int_set (&_ddb_splitter_trace_active, TRUE);
+}
+
+/**
+ * ddb_splitter_trace_stop:
+ *
+ * Stops recording. The events recorded so far are kept until tracing is
+ * started again.
+ **/
+void
+ddb_splitter_trace_stop (void)
+{
+    g_atomic_int_set (&_ddb_splitter_trace_active, FALSE);
+}
+
+/**
+ * ddb_splitter_trace_is_active:
+ *
+ * Returns whether events are being recorded.
+ *
+ * Returns: %TRUE while tracing is active.
+ **/
+gboolean
+ddb_splitter_trace_is_active (void)
+{
+    return g_atomic_int_get (&_ddb_splitter_trace_active);
+}
+
+/* Records one event. @name has to be a static string. The slot is claimed
+ * with an atomic increment, so recording never blocks */
+void
+_ddb_splitter_trace_event (const gchar *name, gchar phase, gconstpointer id, guint depth)
+{
+    /* unsigned, so the counter wraps around instead of overflowing */
+    guint serial = (guint)g_atomic_int_add ((volatile gint *)&trace_head, 1);
+    DdbSplitterTraceEvent *event = &trace_events[serial % DDB_SPLITTER_TRACE_BUFFER_SIZE];
+
+    g_atomic_int_set (&event->serial, 0);
+    event->time = g_get_monotonic_time ();
+    event->tid = ddb_splitter_trace_tid ();
+    event->name = name;
+    event->phase = phase;
+    event->id = id;
+    event->depth = depth;
+    g_atomic_int_set (&event->serial, DDB_SPLITTER_TRACE_TAG (serial));
+}
+
+/**
+ * ddb_splitter_trace_write:
+ * @filename : the file to write the trace to.
+ * @error    : return location for a #GError, or %NULL.
+ *
+ * Writes the recorded events to @filename in the Chrome trace-event JSON
+ * format. Recording goes on while the trace is written, events that are
+ * overwritten in the meantime are left out.
+ *
+ * Returns: %TRUE on success, %FALSE if @error is set.
+ **/
+gboolean
+ddb_splitter_trace_write (const gchar *filename, GError **error)
+{
+    g_return_val_if_fail (filename != NULL, FALSE);
+
+    guint head = (guint)g_atomic_int_get ((volatile gint *)&trace_head);
+    gint pid = getpid ();
+    gboolean sep = FALSE;
+
+    GString *json = g_string_sized_new (DDB_SPLITTER_TRACE_BUFFER_SIZE * 128 + 64);
+    g_string_append (json, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (guint i = 0; i < DDB_SPLITTER_TRACE_BUFFER_SIZE; i++) {
+        /* the last events before head, oldest first; the slots of serial
+         * numbers that were never recorded don't carry their tag */
+        guint serial = head - DDB_SPLITTER_TRACE_BUFFER_SIZE + i;
+        DdbSplitterTraceEvent *event = &trace_events[serial % DDB_SPLITTER_TRACE_BUFFER_SIZE];
+        DdbSplitterTraceEvent copy = *event;
+        gint tag = DDB_SPLITTER_TRACE_TAG (serial);
+
+        /* skip events which are being written or were already replaced */
+        if (copy.serial != tag || g_atomic_int_get (&event->serial) != tag) {
+            continue;
+        }
+        g_string_append_printf (json,
+                "%s\n{\"name\":\"%s\",\"cat\":\"ddb_splitter\",\"ph\":\"%c\",\"ts\":%" G_GINT64_FORMAT
+                ",\"pid\":%d,\"tid\":%d,\"args\":{\"splitter\":\"%p\",\"depth\":%u}}",
+                sep ? "," : "", copy.name, copy.phase, copy.time, pid, copy.tid, copy.id, copy.depth);
+        sep = TRUE;
+    }
+    g_string_append (json, "\n]}\n");
+
+    gboolean res = g_file_set_contents (filename, json->str, json->len, error);
+    g_string_free (json, TRUE);
+    return res;
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2016 Christian Boxdörfer <christian.boxdoerfer@posteo.de>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef __DDB_SPLITTER_TRACE_H__
+#define __DDB_SPLITTER_TRACE_H__
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+void
+ddb_splitter_trace_start (void);
+void
+ddb_splitter_trace_stop (void);
+gboolean
+ddb_splitter_trace_is_active (void);
+gboolean
+ddb_splitter_trace_write (const gchar *filename, GError **error);
+
+/* internal */
+extern volatile gint _ddb_splitter_trace_active;
+
+#define DDB_SPLITTER_TRACE_ACTIVE() G_UNLIKELY (_ddb_splitter_trace_active)
+
+void
+_ddb_splitter_trace_init (void);
+void
+_ddb_splitter_trace_event (const gchar *name, gchar phase, gconstpointer id, guint depth);
+
+G_END_DECLS
+
+#endif /* !__DDB_SPLITTER_TRACE_H__ */